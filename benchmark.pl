@@ -0,0 +1,157 @@
+#!/usr/local/bin/perl
+use warnings;
+use strict;
+use Switch;
+
+use constant false => 0;
+use constant true  => 1;
+
+#Runs eca-multiple-ap over a grid of topologies and protocols at fixed seeds.
+#Every run appends one line to tmp3/benchmark.dat (see --benchmark in
+#eca-multiple-ap.cc for the columns).
+#
+# ./benchmark.pl small|large|production|saturated [output] runs a grid
+# ./benchmark.pl compare <new.dat> <baseline.dat>          compares two runs of a grid
+#
+#The saturated grid compares builds, e.g. with and without the hot path logs:
+# ./waf configure --build-profile=debug && ./benchmark.pl saturated debug.dat
+# CXXFLAGS="-DWIFI_QUIET_HOT_PATHS" ./waf configure --build-profile=debug && ./benchmark.pl saturated quiet.dat
+# ./benchmark.pl compare tmp3/quiet.dat tmp3/debug.dat
+#Both builds must come from the same checkout and machine; quote the
+#geometric mean line of the comparison when reporting a speed-up.
+
+my $grid = $ARGV[0];
+my $outputFile = 'benchmark.dat';
+$outputFile = $ARGV[1]
+	if ($#ARGV >= 1 && $grid ne "compare");
+my $tolerance = 0.10; #relative slowdown reported as a regression
+
+if ($grid eq "compare")
+{
+	compare($ARGV[1], $ARGV[2]);
+	exit(0);
+}
+
+my @nWifis;
+my @nStas;
+my @positions;
+my @seeds = (1);
+my $simulationTime = 2;
+my $saturation = true;
+#eca hyst bitmap fairShare fairShareAMPDU
+my @protocols = ([false, false, false, false, false], #DCF
+                 [true, true, false, false, false],   #ECA
+                 [true, true, true, false, false],    #ECA + Schedule Reset
+                 [true, true, false, false, true]);   #ECA + fair share (A-MPDU)
+
+switch ($grid){
+	case "small"{
+		@nWifis = (1, 4);
+		@nStas = (5, 10);
+		@positions = (3, 5);
+	}
+	case "large"{
+		@nWifis = (10, 50);
+		@nStas = (10, 20);
+		@positions = (5);
+		$simulationTime = 1;
+	}
+	case "production"{
+		@nWifis = (100);
+		@nStas = (50);
+		@positions = (5);
+		@protocols = ([false, false, false, false, false], [true, true, true, false, true]);
+		$simulationTime = 1;
+	}
+	case "saturated"{
+		@nWifis = (1);
+		@nStas = (10, 30);
+		@positions = (3);
+		@seeds = (1, 2, 3);
+		@protocols = ([false, false, false, false, false], [true, true, true, false, false]);
+		$simulationTime = 10;
+		$saturation = true;
+	}
+	else{
+		die "Usage: $0 small|large|production|saturated [output], or $0 compare <new.dat> <baseline.dat>\n";
+	}
+}
+
+my $command = './waf --cwd=tmp3/ --run "scratch/eca-multiple-ap';
+foreach my $seed (@seeds){
+	foreach my $wifis (@nWifis){
+		foreach my $stas (@nStas){
+			foreach my $position (@positions){
+				foreach my $protocol (@protocols){
+					my ($eca, $hyst, $bitmap, $fairShare, $fairShareAMPDU) = @$protocol;
+					my $addition = "--nWifis=$wifis --nStas=$stas --seed=$seed"
+						." --simulationTime=$simulationTime --defaultPositions=$position"
+						." --xDistanceFromAp=5 --channelAllocation=true"
+						." --eca=$eca --hyst=$hyst --stickiness=$eca --bitmap=$bitmap --dynStick=$bitmap"
+						." --fairShare=$fairShare --fairShareAMPDU=$fairShareAMPDU --saturation=$saturation"
+						." --benchmark=$outputFile\"";
+					print("###Benchmark: $addition\n");
+					system("$command $addition");
+				}
+			}
+		}
+	}
+}
+
+#Columns 1-9 identify a benchmark point
+sub load {
+	my ($file) = @_;
+	my %points;
+	open(my $input, "<", $file)
+		or die "Could not open file '$file' $!";
+	while (my $row = <$input>){
+		chomp($row);
+		my @data = split(/\s+/, $row);
+		next
+			if ($#data < 16);
+		my $key = join(" ", @data[0 .. 8]);
+		$points{$key} = \@data;
+	}
+	return \%points;
+}
+
+sub compare {
+	my ($newFile, $baseFile) = @_;
+	my $new = load($newFile);
+	my $base = load($baseFile);
+	my $regressions = 0;
+	my $matched = 0;
+	my $logWall = 0;
+	my $logEvents = 0;
+
+	print("#nWifis nStas eca hyst bitmap fairShare fairShareAMPDU positions seed "
+		."wall(new/base) events/s(new/base) rss(new/base) delivered(new-base)\n");
+	foreach my $key (sort keys %$new){
+		next
+			if (!exists $base->{$key});
+		my @n = @{$new->{$key}};
+		my @b = @{$base->{$key}};
+		my $wall = $b[11] > 0 ? $n[11] / $b[11] : 0;
+		my $events = $b[14] > 0 ? $n[14] / $b[14] : 0;
+		my $rss = $b[15] > 0 ? $n[15] / $b[15] : 0;
+		my $delivered = $n[16] - $b[16];
+		my $flag = "";
+		if ($wall > 1 + $tolerance){
+			$flag = " <- slower";
+			$regressions++;
+		}
+		$flag = "$flag <- different results"
+			if ($delivered != 0);
+		printf("%s %.3f %.3f %.3f %d%s\n", $key, $wall, $events, $rss, $delivered, $flag);
+		if ($wall > 0 && $events > 0){
+			$matched++;
+			$logWall += log($wall);
+			$logEvents += log($events);
+		}
+	}
+	print("-Points slower than the baseline by more than ".($tolerance * 100)."%: $regressions\n");
+	#Geometric means, the one line to quote when a build claims a speed-up
+	printf("-Geometric mean over %d points: wall %.3f events/s %.3f (new/base)\n",
+		$matched, exp($logWall / $matched), exp($logEvents / $matched))
+		if ($matched > 0);
+}
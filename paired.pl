@@ -0,0 +1,149 @@
+#!/usr/local/bin/perl
+use warnings;
+use strict;
+use List::Util qw(sum);
+use Switch;
+
+use constant false => 0;
+use constant true  => 1;
+
+#Paired comparison of an ECA variant against DCF with common random numbers.
+#Every replication runs DCF and the variant on the same seed with
+#--nodeStreams, so placement, channel and traffic draw the same numbers in
+#both runs and only the MAC differs. The two runs of a pair are executed at
+#the same time, each in its own directory under tmp3/paired/.
+#
+# ./paired.pl ECA|ECA+hyst|ECA+bitmap|ECA+fairShare [nWifis] [nStas] [reps]
+#
+#For every replication the difference (variant - DCF) of the throughput of
+#the topology, the mean JFI and the mean fraction of failures is printed,
+#followed by the mean difference with its 95% confidence interval, and the
+#half-width an unpaired comparison of the same runs would have.
+
+my $variant = $ARGV[0];
+my $nWifis = defined $ARGV[1] ? $ARGV[1] : 4;
+my $nStas = defined $ARGV[2] ? $ARGV[2] : 10;
+my $rep = defined $ARGV[3] ? $ARGV[3] : 10;
+my $simulationTime = 10;
+my $defaultPositions = 5;
+my $saturation = true;
+
+#eca hyst stickiness bitmap dynStick fairShare
+my @dcf = (false, false, 0, false, false, false);
+my @eca;
+switch ($variant){
+	case "ECA"{
+		@eca = (true, false, 0, false, false, false);
+	}
+	case "ECA+hyst"{
+		@eca = (true, true, 1, false, false, false);
+	}
+	case "ECA+bitmap"{
+		@eca = (true, true, 1, true, true, false);
+	}
+	case "ECA+fairShare"{
+		@eca = (true, true, 1, false, false, true);
+	}
+	else{
+		die "Usage: $0 ECA|ECA+hyst|ECA+bitmap|ECA+fairShare [nWifis] [nStas] [reps]\n";
+	}
+}
+
+#Two-sided 95% quantiles of the t distribution, by degrees of freedom
+my @t95 = (0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+           2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+           2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042);
+
+#Built once, so the runs of a pair do not race to build it
+system("./waf build") == 0
+	or die "Could not build\n";
+
+my @metrics = ("Throughput (Mbps)", "JFI", "Fraction of failures");
+my (@base, @other, @diff);
+foreach my $seed (1 .. $rep){
+	my $baseDir = "tmp3/paired/DCF-$seed";
+	my $otherDir = "tmp3/paired/$variant-$seed";
+	my @pids;
+	foreach my $run ([$baseDir, \@dcf], [$otherDir, \@eca]){
+		my ($dir, $protocol) = @$run;
+		my $pid = fork();
+		die "Could not fork\n"
+			if (!defined $pid);
+		if ($pid == 0){
+			simulate($dir, $seed, @$protocol);
+			exit(0);
+		}
+		push(@pids, $pid);
+	}
+	waitpid($_, 0)
+		foreach (@pids);
+
+	my @b = summary("$baseDir/results3.log");
+	my @o = summary("$otherDir/results3.log");
+	my @d = map { $o[$_] - $b[$_] } (0 .. $#metrics);
+	push(@base, \@b);
+	push(@other, \@o);
+	push(@diff, \@d);
+	printf("###Pair %d: throughput %+.4f Mbps, JFI %+.4f, failures %+.4f\n", $seed, @d);
+}
+
+print("\n#$variant - DCF, $nWifis Wlans of $nStas Stas, $rep pairs\n");
+print("#metric mean-difference paired-95%CI unpaired-95%CI\n");
+foreach my $m (0 .. $#metrics){
+	my ($mean, $var) = stats(map { $_->[$m] } @diff);
+	my ($meanBase, $varBase) = stats(map { $_->[$m] } @base);
+	my ($meanOther, $varOther) = stats(map { $_->[$m] } @other);
+	my $t = quantile($rep - 1);
+	my $paired = $t * sqrt($var / $rep);
+	my $unpaired = $t * sqrt(($varBase + $varOther) / $rep);
+	printf("%s: %+.4f +- %.4f (unpaired +- %.4f)\n", $metrics[$m], $mean, $paired, $unpaired);
+}
+
+sub simulate {
+	my ($dir, $seed, $eca, $hyst, $stickiness, $bitmap, $dynStick, $fairShare) = @_;
+	system("rm -rf $dir && mkdir -p $dir");
+	my $addition = "--nWifis=$nWifis --nStas=$nStas --seed=$seed --nodeStreams=true"
+		." --simulationTime=$simulationTime --defaultPositions=$defaultPositions"
+		." --xDistanceFromAp=5 --channelAllocation=true --saturation=$saturation"
+		." --eca=$eca --hyst=$hyst --stickiness=$stickiness --bitmap=$bitmap --dynStick=$dynStick"
+		." --fairShare=$fairShare";
+	system("./waf --cwd=$dir --run \"scratch/eca-multiple-ap $addition\" > $dir/output.log 2>&1");
+}
+
+#Throughput of the topology, mean JFI and mean fraction of failures of a run
+sub summary {
+	my ($file) = @_;
+	my (@throughput, @failures, @jfi);
+	open(my $input, "<", $file)
+		or die "Could not open file '$file' $!";
+	while (my $row = <$input>){
+		chomp($row);
+		my @data = split(/\s+/, $row);
+		next
+			if ($#data < 6);
+		push(@throughput, $data[2]);
+		push(@failures, $data[3]);
+		push(@jfi, $data[4]);
+	}
+	close($input);
+	die "No results in '$file'\n"
+		if (!@throughput);
+	return (sum(@throughput), sum(@jfi) / @jfi, sum(@failures) / @failures);
+}
+
+#Mean and sample variance
+sub stats {
+	my @x = @_;
+	my $mean = sum(@x) / @x;
+	return ($mean, 0)
+		if (@x < 2);
+	my $var = sum(map { ($_ - $mean) ** 2 } @x) / (@x - 1);
+	return ($mean, $var);
+}
+
+sub quantile {
+	my ($df) = @_;
+	return 0
+		if ($df < 1);
+	return $df <= $#t95 ? $t95[$df] : 1.96;
+}
@@ -0,0 +1,442 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Luis Sanabria-Russo <luis.sanabria@upf.edu>
+ */
+
+// Microbenchmarks of the wifi components that dominate the profiles of
+// eca-multiple-ap, driven with synthetic inputs and no full scenario:
+//
+// - dcf: DcfManager with k saturated DcfStates (RequestAccess, backoff
+//   updates and grants) under bursts of PHY receptions. An op is a call
+//   into DcfManager, including the events it schedules.
+// - interference: InterferenceHelper::Add and CalculatePlcpPayloadSnrPer
+//   for a frame overlapped by d interferers. An op is one frame.
+// - channel-send: YansWifiChannel::Send fan-out to N PHYs. An op is one
+//   Send; channel-deliver is the cost of running the receptions it
+//   scheduled, per receiving PHY.
+// - stations: WifiRemoteStationManager::GetDataTxVector round robin over
+//   M stations. An op is one lookup.
+//
+// Every parameter is swept doubling from 1 to its maximum. Each row is:
+// benchmark parameter ops ns/op allocs/op
+//
+// ./waf --run "eca-microbench --bench=dcf --dcfStates=8"
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <chrono>
+#include <stdint.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("EcaMicrobench");
+
+/* Every allocation of the process goes through these */
+static uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    throw std::bad_alloc ();
+  return p;
+}
+
+void *
+operator new[] (size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    throw std::bad_alloc ();
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) throw ()
+{
+  std::free (p);
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+double
+ElapsedNs (bench_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano> (bench_clock::now () - start).count ();
+}
+
+void
+Report (const char *name, uint32_t parameter, uint64_t ops, double ns, uint64_t allocations)
+{
+  if (ops == 0)
+    ops = 1;
+  std::printf ("%s %u %llu %.1f %.2f\n", name, parameter, (unsigned long long) ops,
+               ns / ops, (double) allocations / ops);
+}
+
+/* DcfManager */
+
+static uint64_t g_dcfCalls = 0;
+
+class BenchDcfState : public DcfState
+{
+public:
+  BenchDcfState (Ptr<DcfManager> manager, Ptr<UniformRandomVariable> rng, Time txDuration)
+    : m_grants (0),
+      m_manager (manager),
+      m_rng (rng),
+      m_txDuration (txDuration)
+  {
+  }
+  void Request (void)
+  {
+    g_dcfCalls++;
+    m_manager->RequestAccess (this);
+  }
+  uint64_t m_grants;
+
+private:
+  void Backoff (void)
+  {
+    StartBackoffNow (m_rng->GetInteger (0, GetCw ()));
+  }
+  virtual void DoNotifyAccessGranted (void)
+  {
+    m_grants++;
+    g_dcfCalls++;
+    m_manager->NotifyTxStartNow (m_txDuration);
+    ResetCw ();
+    Backoff ();
+    Simulator::Schedule (m_txDuration, &BenchDcfState::Request, this);
+  }
+  virtual void DoNotifyInternalCollision (void)
+  {
+    UpdateFailedCw ();
+    Backoff ();
+    Request ();
+  }
+  virtual void DoNotifyCollision (void)
+  {
+    Backoff ();
+    Request ();
+  }
+  virtual void DoNotifyChannelSwitching (void)
+  {
+  }
+  virtual void DoNotifySleep (void)
+  {
+  }
+  virtual void DoNotifyWakeUp (void)
+  {
+  }
+
+  Ptr<DcfManager> m_manager;
+  Ptr<UniformRandomVariable> m_rng;
+  Time m_txDuration;
+};
+
+void
+RxEnd (Ptr<DcfManager> manager)
+{
+  g_dcfCalls++;
+  manager->NotifyRxEndOkNow ();
+}
+
+void
+RxStart (Ptr<DcfManager> manager, Time duration)
+{
+  g_dcfCalls++;
+  manager->NotifyRxStartNow (duration);
+  Simulator::Schedule (duration, &RxEnd, manager);
+}
+
+/* Back to back receptions separated by SIFS, then an exponential gap */
+void
+RxBurst (Ptr<DcfManager> manager, Ptr<UniformRandomVariable> rng, uint32_t burstLength,
+         Time rxDuration, Time sifs, Time meanGap)
+{
+  for (uint32_t i = 0; i < burstLength; i++)
+    Simulator::Schedule ((rxDuration + sifs) * i, &RxStart, manager, rxDuration);
+  Time gap = (rxDuration + sifs) * burstLength
+    + NanoSeconds (-std::log (1 - rng->GetValue ()) * meanGap.GetNanoSeconds ());
+  Simulator::Schedule (gap, &RxBurst, manager, rng, burstLength, rxDuration, sifs, meanGap);
+}
+
+void
+BenchDcf (uint32_t maxStates, double simTime, uint32_t burstLength)
+{
+  for (uint32_t k = 1; k <= maxStates; k *= 2)
+    {
+      Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+      rng->SetStream (k);
+      Ptr<DcfManager> manager = CreateObject<DcfManager> ();
+      manager->SetSlot (MicroSeconds (9));
+      manager->SetSifs (MicroSeconds (16));
+      manager->SetEifsNoDifs (MicroSeconds (16 + 44));
+
+      std::vector<BenchDcfState *> states;
+      for (uint32_t i = 0; i < k; i++)
+        {
+          BenchDcfState *state = new BenchDcfState (manager, rng, MicroSeconds (300));
+          state->SetAifsn (2 + i);
+          state->SetCwMin (15);
+          state->SetCwMax (1023);
+          state->ResetCw ();
+          manager->Add (state);
+          states.push_back (state);
+        }
+      for (uint32_t i = 0; i < k; i++)
+        Simulator::Schedule (MicroSeconds (i), &BenchDcfState::Request, states.at (i));
+      Simulator::Schedule (MicroSeconds (50), &RxBurst, manager, rng, burstLength,
+                           MicroSeconds (200), MicroSeconds (16), MilliSeconds (1));
+      Simulator::Stop (Seconds (simTime));
+
+      g_dcfCalls = 0;
+      uint64_t allocations = g_allocations;
+      bench_clock::time_point start = bench_clock::now ();
+      Simulator::Run ();
+      double ns = ElapsedNs (start);
+      Report ("dcf", k, g_dcfCalls, ns, g_allocations - allocations);
+
+      Simulator::Destroy ();
+      for (uint32_t i = 0; i < k; i++)
+        delete states.at (i);
+    }
+}
+
+/* InterferenceHelper */
+
+WifiTxVector
+GetBenchTxVector (void)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  txVector.SetTxPowerLevel (0);
+  txVector.SetChannelWidth (20);
+  txVector.SetNss (1);
+  return txVector;
+}
+
+void
+BenchInterference (uint32_t maxOverlap, uint64_t ops)
+{
+  WifiTxVector txVector = GetBenchTxVector ();
+  Time duration = MicroSeconds (1000);
+  for (uint32_t d = 1; d <= maxOverlap; d *= 2)
+    {
+      InterferenceHelper interference;
+      interference.SetNoiseFigure (std::pow (10.0, 7 / 10.0));
+      interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+
+      double sum = 0;
+      uint64_t allocations = g_allocations;
+      bench_clock::time_point start = bench_clock::now ();
+      for (uint64_t op = 0; op < ops; op++)
+        {
+          /* Interferers start along the frame, so every one is a change */
+          for (uint32_t i = 0; i < d; i++)
+            interference.Add (1500, txVector, WIFI_PREAMBLE_LONG,
+                              duration - MicroSeconds (i % 500), 1e-11);
+          Ptr<InterferenceHelper::Event> event = interference.Add (1500, txVector, WIFI_PREAMBLE_LONG,
+                                                                   duration, 1e-9);
+          interference.NotifyRxStart ();
+          struct InterferenceHelper::SnrPer snrPer = interference.CalculatePlcpPayloadSnrPer (event);
+          interference.NotifyRxEnd ();
+          interference.EraseEvents ();
+          sum += snrPer.per;
+        }
+      double ns = ElapsedNs (start);
+      Report ("interference", d, ops, ns, g_allocations - allocations);
+      NS_LOG_DEBUG ("PER sum " << sum);
+    }
+}
+
+/* YansWifiChannel */
+
+static uint64_t g_received = 0;
+
+void
+BenchRxOk (Ptr<Packet> packet, double snr, WifiTxVector txVector, enum WifiPreamble preamble)
+{
+  g_received++;
+}
+
+void
+BenchRxError (Ptr<const Packet> packet, double snr)
+{
+  g_received++;
+}
+
+std::vector<Ptr<YansWifiPhy> >
+CreateBenchPhys (uint32_t n, Ptr<YansWifiChannel> channel)
+{
+  std::vector<Ptr<YansWifiPhy> > phys;
+  uint32_t side = std::ceil (std::sqrt ((double) n));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector ((i % side) * 5.0, (i / side) * 5.0, 0.0));
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+      phy->SetMobility (mobility);
+      phy->SetChannel (channel);
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phy->SetReceiveOkCallback (MakeCallback (&BenchRxOk));
+      phy->SetReceiveErrorCallback (MakeCallback (&BenchRxError));
+      phys.push_back (phy);
+    }
+  return phys;
+}
+
+void
+BenchChannel (uint32_t maxPhys, uint64_t ops)
+{
+  WifiTxVector txVector = GetBenchTxVector ();
+  struct mpduInfo aMpdu;
+  aMpdu.packetType = 0;
+  aMpdu.referenceNumber = 0;
+  Time duration = MicroSeconds (20 + 1500 * 8 / 6);
+  for (uint32_t n = 2; n <= maxPhys; n *= 2)
+    {
+      Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+      channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+      channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+      std::vector<Ptr<YansWifiPhy> > phys = CreateBenchPhys (n, channel);
+      Ptr<Packet> packet = Create<Packet> (1500);
+
+      double sendNs = 0;
+      double deliverNs = 0;
+      uint64_t sendAllocations = 0;
+      uint64_t deliverAllocations = 0;
+      g_received = 0;
+      for (uint64_t op = 0; op < ops; op++)
+        {
+          uint64_t allocations = g_allocations;
+          bench_clock::time_point start = bench_clock::now ();
+          channel->Send (phys.at (op % n), packet, 16.0206, txVector, WIFI_PREAMBLE_LONG, aMpdu, duration);
+          sendNs += ElapsedNs (start);
+          sendAllocations += g_allocations - allocations;
+
+          /* The receptions end before the next Send, so they never overlap */
+          allocations = g_allocations;
+          start = bench_clock::now ();
+          Simulator::Run ();
+          deliverNs += ElapsedNs (start);
+          deliverAllocations += g_allocations - allocations;
+        }
+      Report ("channel-send", n, ops, sendNs, sendAllocations);
+      Report ("channel-deliver", n, ops * (n - 1), deliverNs, deliverAllocations);
+      NS_LOG_DEBUG ("Frames received " << g_received);
+      Simulator::Destroy ();
+    }
+}
+
+/* WifiRemoteStationManager */
+
+void
+BenchStations (uint32_t maxStations, uint64_t ops)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<YansWifiPhy> phy = CreateBenchPhys (1, channel).at (0);
+  Ptr<Packet> packet = Create<Packet> (1500);
+  for (uint32_t m = 1; m <= maxStations; m *= 2)
+    {
+      Ptr<ConstantRateWifiManager> manager = CreateObject<ConstantRateWifiManager> ();
+      manager->SetupPhy (phy);
+      std::vector<Mac48Address> addresses;
+      for (uint32_t i = 0; i < m; i++)
+        addresses.push_back (Mac48Address::Allocate ());
+
+      WifiMacHeader header;
+      header.SetType (WIFI_MAC_DATA);
+      /* The first lookup of a station creates it */
+      for (uint32_t i = 0; i < m; i++)
+        {
+          header.SetAddr1 (addresses.at (i));
+          manager->GetDataTxVector (addresses.at (i), &header, packet, 1500);
+        }
+
+      uint32_t modes = 0;
+      uint64_t allocations = g_allocations;
+      bench_clock::time_point start = bench_clock::now ();
+      for (uint64_t op = 0; op < ops; op++)
+        {
+          Mac48Address address = addresses.at (op % m);
+          header.SetAddr1 (address);
+          modes += manager->GetDataTxVector (address, &header, packet, 1500).GetNss ();
+        }
+      double ns = ElapsedNs (start);
+      Report ("stations", m, ops, ns, g_allocations - allocations);
+      NS_LOG_DEBUG ("Nss sum " << modes);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  std::string bench ("all");
+  uint64_t ops = 100000;
+  uint32_t dcfStates = 8;
+  uint32_t burstLength = 4;
+  double simTime = 10;
+  uint32_t overlap = 64;
+  uint32_t phys = 128;
+  uint32_t stations = 256;
+
+  CommandLine cmd;
+  cmd.AddValue ("bench", "Benchmark to run: all, dcf, interference, channel or stations", bench);
+  cmd.AddValue ("ops", "Operations per point of the interference, channel and stations benchmarks", ops);
+  cmd.AddValue ("dcfStates", "Maximum number of DcfStates in the DcfManager", dcfStates);
+  cmd.AddValue ("burstLength", "Receptions per burst of PHY notifications", burstLength);
+  cmd.AddValue ("simTime", "Simulated seconds per point of the DcfManager benchmark", simTime);
+  cmd.AddValue ("overlap", "Maximum number of interferers per frame", overlap);
+  cmd.AddValue ("phys", "Maximum number of PHYs on the channel", phys);
+  cmd.AddValue ("stations", "Maximum number of remote stations", stations);
+  cmd.Parse (argc, argv);
+
+  std::printf ("#1 Benchmark #2 Parameter #3 Ops #4 ns/op #5 allocs/op\n");
+  if (bench == "all" || bench == "dcf")
+    BenchDcf (dcfStates, simTime, burstLength);
+  if (bench == "all" || bench == "interference")
+    BenchInterference (overlap, ops);
+  if (bench == "all" || bench == "channel")
+    BenchChannel (phys, ops);
+  if (bench == "all" || bench == "stations")
+    BenchStations (stations, ops);
+  Simulator::Destroy ();
+  return 0;
+}
@@ -65,6 +65,19 @@
 #include <stdint.h>
 #include <sstream>
 #include <fstream>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <sys/resource.h>
+#include "ns3/scheduler.h"
+#include <map>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cstring>
+#include <cerrno>
 
 
 //Defining log codes for interesting metrics
@@ -76,6 +89,23 @@
 #define FSAGG 6 //# of frames aggregated
 #define COLTX 7 //# Tx while channel busy
 
+//Why the run stopped
+#define STOP_MAXTIME 0 //simulationTime elapsed
+#define STOP_CONVERGED 1 //convergence monitor
+
+//Components of a node with their own RNG stream (see GetNodeStream)
+#define RNG_DCA 0 //DcaTxop
+#define RNG_EDCA 1 //EdcaTxopN, VO, VI, BE and BK
+#define RNG_PHY 5 //YansWifiPhy
+#define RNG_BEACON 6 //ApWifiMac beacon jitter
+#define RNG_BEACON_DCA 7 //DcaTxop of the beacons
+#define RNG_MOBILITY 8 //RandomWalk2dMobilityModel, speed and direction
+#define RNG_ARP 10 //ArpL3Protocol request jitter
+#define RNG_POSITION 11 //placement of the Wlan, x, y and z (AP only)
+#define RNG_LOSS 14 //loss models of the channel, up to 18 (first AP of the channel only)
+#define RNG_COMPONENTS 32
+#define RNG_NODES 4096 //per Wlan, AP included
+
 using namespace ns3;
 
 struct sim_config
@@ -116,11 +146,50 @@ struct sim_config
   bool dynStick;
   bool srResetMode;
   bool srConservative;
+  uint32_t srWindow;
+  bool ecaController;
+  double targetEmptySlots;
+  double targetCollisions;
+  uint32_t controllerWindow;
+  uint32_t controllerMaxStickiness;
+  uint32_t rtsSuppression;
   uint32_t stickiness;
   uint32_t maxMsdus;
 
   /* Traffic specific */
   bool saturation;
+  bool downlink;
+
+  /* Slot statistics of the first Sta of each Wlan */
+  bool slotStats;
+  uint32_t slotHistogramBins;
+
+  /* Startup */
+  bool preassociate;
+  double startTime;
+
+  /* Convergence monitor */
+  bool convergence;
+  double convergenceWindow;
+  double convergenceCi;
+  uint32_t convergenceMinWindows;
+
+  /* Cycle skipping */
+  bool cycleSkip;
+  uint32_t cycleSkipCycles;
+
+  /* Random streams keyed by Wlan, node and component */
+  bool nodeStreams;
+
+  /* Logical processes */
+  bool partitions;
+  std::vector<uint32_t> wlanLp;
+  uint32_t nLps;
+
+  /* Parallel logical processes */
+  std::vector<int32_t> nodeLp; // by node id, -1: not in a Wlan
+  int32_t runLp; // LP of this process, -1: all of them
+  int lpFd; // pipe to the parent
 };
 struct sim_config config;
 
@@ -142,9 +211,369 @@ struct sim_results{
 
   uint64_t lastFailure;
   uint64_t lastCollision;
+
+  double elapsedTime; // seconds of traffic the results refer to
+  uint32_t stopReason;
+
+  /* Credited by the cycle skipping instead of simulated */
+  std::vector< std::vector<uint64_t> > creditedPackets;
+  uint64_t skippedCycles;
+  double skippedTime;
 };
 struct sim_results results;
 
+/* Event loop profiling: a scheduler that hands the events to the real one
+ * and attributes the events and the wall time between taking an event and
+ * the loop asking for the next one to the type of the scheduled callback
+ * (its class, signature and bound object type). Cancelled events are taken
+ * out of the scheduler as well, so they are counted too. */
+class EventProfilingScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  EventProfilingScheduler ();
+  virtual ~EventProfilingScheduler ();
+
+  void SetScheduler (std::string type);
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  struct event_profile
+  {
+    uint64_t events;
+    double wallTime; // seconds
+  };
+  typedef std::map<const char *, struct event_profile> Profiles;
+
+  void StopEvent (void) const;
+  void Dump (std::string title) const;
+  void Report (void);
+
+  Ptr<Scheduler> m_scheduler;
+  Time m_snapshotInterval;
+  uint64_t m_nextSnapshot; // time steps
+  bool m_reportScheduled;
+  bool m_reported;
+  mutable Profiles m_profiles;
+  mutable struct event_profile *m_running;
+  mutable std::chrono::steady_clock::time_point m_start;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (EventProfilingScheduler);
+
+TypeId
+EventProfilingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EventProfilingScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<EventProfilingScheduler> ()
+    .AddAttribute ("SchedulerType",
+                   "The scheduler that keeps the events.",
+                   StringValue ("ns3::MapScheduler"),
+                   MakeStringAccessor (&EventProfilingScheduler::SetScheduler),
+                   MakeStringChecker ())
+    .AddAttribute ("SnapshotInterval",
+                   "Simulated time between the reports of the events so far (0: only at Simulator::Destroy).",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&EventProfilingScheduler::m_snapshotInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+EventProfilingScheduler::EventProfilingScheduler ()
+  : m_nextSnapshot (0),
+    m_reportScheduled (false),
+    m_reported (false),
+    m_running (0)
+{
+}
+
+EventProfilingScheduler::~EventProfilingScheduler ()
+{
+}
+
+void
+EventProfilingScheduler::SetScheduler (std::string type)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  m_scheduler = factory.Create<Scheduler> ();
+}
+
+void
+EventProfilingScheduler::Insert (const Event &ev)
+{
+  m_scheduler->Insert (ev);
+}
+
+/* The event loop checks for more events after every event */
+bool
+EventProfilingScheduler::IsEmpty (void) const
+{
+  StopEvent ();
+  return m_scheduler->IsEmpty ();
+}
+
+Scheduler::Event
+EventProfilingScheduler::PeekNext (void) const
+{
+  return m_scheduler->PeekNext ();
+}
+
+Scheduler::Event
+EventProfilingScheduler::RemoveNext (void)
+{
+  StopEvent ();
+  Event ev = m_scheduler->RemoveNext ();
+  /* Simulator::Destroy drops the events left after the report */
+  if (m_reported)
+    return ev;
+  if (!m_reportScheduled)
+    {
+      Simulator::ScheduleDestroy (&EventProfilingScheduler::Report, this);
+      m_reportScheduled = true;
+    }
+  if (!m_snapshotInterval.IsZero () && ev.key.m_ts >= m_nextSnapshot)
+    {
+      if (m_nextSnapshot > 0)
+        {
+          std::ostringstream title;
+          title << "-Events until " << TimeStep (m_nextSnapshot).GetSeconds () << " s";
+          Dump (title.str ());
+        }
+      while (m_nextSnapshot <= ev.key.m_ts)
+        m_nextSnapshot += m_snapshotInterval.GetTimeStep ();
+    }
+  struct event_profile &profile = m_profiles[typeid (*ev.impl).name ()];
+  profile.events++;
+  m_running = &profile;
+  m_start = std::chrono::steady_clock::now ();
+  return ev;
+}
+
+void
+EventProfilingScheduler::Remove (const Event &ev)
+{
+  m_scheduler->Remove (ev);
+}
+
+void
+EventProfilingScheduler::StopEvent (void) const
+{
+  if (m_running == 0)
+    return;
+  m_running->wallTime += std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+  m_running = 0;
+}
+
+/* Sorted by wall time, with the demangled callback types */
+void
+EventProfilingScheduler::Dump (std::string title) const
+{
+  std::vector<std::pair<double, std::string> > rows;
+  uint64_t events = 0;
+  double wallTime = 0;
+  for (Profiles::const_iterator it = m_profiles.begin (); it != m_profiles.end (); it++)
+    {
+      int status;
+      char *name = abi::__cxa_demangle (it->first, 0, 0, &status);
+      std::ostringstream row;
+      row << it->second.events << "\t" << it->second.wallTime << " s\t"
+          << (status == 0 ? name : it->first);
+      std::free (name);
+      rows.push_back (std::make_pair (it->second.wallTime, row.str ()));
+      events += it->second.events;
+      wallTime += it->second.wallTime;
+    }
+  std::sort (rows.rbegin (), rows.rend ());
+  std::cout << title << ": " << events << " events, " << wallTime << " s" << std::endl;
+  for (uint32_t i = 0; i < rows.size (); i++)
+    std::cout << "\t" << rows.at (i).second << std::endl;
+}
+
+void
+EventProfilingScheduler::Report (void)
+{
+  StopEvent ();
+  Dump ("-Events");
+  m_reported = true;
+}
+
+/* Keeps the events of the nodes of one logical process. The events of the
+ * nodes of other processes are taken out of the real scheduler already
+ * cancelled, so their chains die out after the first one. Events without
+ * a node (setup and results) are kept by every process. An event of this
+ * process that schedules one on a node of another process (e.g. a frame
+ * flooded through the backbone) would be lost, so it aborts the run. */
+class LpFilterScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LpFilterScheduler ();
+  virtual ~LpFilterScheduler ();
+
+  void SetScheduler (std::string type);
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  Ptr<Scheduler> m_scheduler;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (LpFilterScheduler);
+
+TypeId
+LpFilterScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LpFilterScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LpFilterScheduler> ()
+    .AddAttribute ("SchedulerType",
+                   "The scheduler that keeps the events.",
+                   StringValue ("ns3::MapScheduler"),
+                   MakeStringAccessor (&LpFilterScheduler::SetScheduler),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+LpFilterScheduler::LpFilterScheduler ()
+{
+}
+
+LpFilterScheduler::~LpFilterScheduler ()
+{
+}
+
+void
+LpFilterScheduler::SetScheduler (std::string type)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  m_scheduler = factory.Create<Scheduler> ();
+}
+
+void
+LpFilterScheduler::Insert (const Event &ev)
+{
+  uint32_t from = Simulator::GetContext ();
+  uint32_t to = ev.key.m_context;
+  NS_ABORT_MSG_IF (config.runLp >= 0 && from < config.nodeLp.size () && to < config.nodeLp.size ()
+                   && config.nodeLp.at (from) == config.runLp
+                   && config.nodeLp.at (to) >= 0 && config.nodeLp.at (to) != config.runLp,
+                   "Node " << from << " of LP " << config.runLp << " scheduled an event on node " << to
+                   << " of LP " << config.nodeLp.at (to) << ": the logical processes are not independent");
+  m_scheduler->Insert (ev);
+}
+
+bool
+LpFilterScheduler::IsEmpty (void) const
+{
+  return m_scheduler->IsEmpty ();
+}
+
+Scheduler::Event
+LpFilterScheduler::PeekNext (void) const
+{
+  return m_scheduler->PeekNext ();
+}
+
+Scheduler::Event
+LpFilterScheduler::RemoveNext (void)
+{
+  Event ev = m_scheduler->RemoveNext ();
+  uint32_t context = ev.key.m_context;
+  if (config.runLp >= 0 && context < config.nodeLp.size ()
+      && config.nodeLp.at (context) >= 0 && config.nodeLp.at (context) != config.runLp)
+    ev.impl->Cancel ();
+  return ev;
+}
+
+void
+LpFilterScheduler::Remove (const Event &ev)
+{
+  m_scheduler->Remove (ev);
+}
+
+/* Welford's running mean and variance */
+struct running_stat
+{
+  uint64_t n;
+  double mean;
+  double m2;
+};
+
+void
+AddSample (struct running_stat &stat, double x)
+{
+  stat.n++;
+  double delta = x - stat.mean;
+  stat.mean += delta / stat.n;
+  stat.m2 += delta * (x - stat.mean);
+}
+
+/* Half-width of the 95% confidence interval of the mean */
+double
+GetCiHalfWidth (struct running_stat &stat)
+{
+  if (stat.n < 2)
+    return std::numeric_limits<double>::max ();
+  return 1.96 * std::sqrt (stat.m2 / (stat.n - 1) / stat.n);
+}
+
+/* Batch means over fixed windows of the MAC and Udp server counters */
+struct convergence_monitor
+{
+  std::vector< std::vector<uint64_t> > lastReceived;
+  uint64_t lastSx;
+  uint64_t lastFailed;
+  struct running_stat throughput;
+  struct running_stat failFrac;
+  struct running_stat jfi;
+
+  /* What finalResults needs when stopping early */
+  EventId finalEvent;
+  Ptr<OutputStreamWrapper> staStream;
+  std::vector<NodeContainer> sta;
+};
+struct convergence_monitor monitor;
+
+/* Detects a collision-free CSMA/ECA schedule repeating itself. A cycle goes
+ * from one success of an anchor node to the next one, and is described by
+ * the successes of every node in between. */
+struct cycle_skip
+{
+  bool active; // whether a cycle is open
+  uint32_t anchorWlan;
+  uint32_t anchorNode;
+  Time cycleStart;
+  std::vector< std::vector<uint64_t> > cycleReceived; // Udp server counters at cycleStart
+  std::vector< std::vector<uint32_t> > current; // successes in the open cycle
+  std::vector< std::vector<uint32_t> > pattern; // successes per cycle of the stable schedule
+  uint32_t stableCycles;
+  Time stableStart;
+  std::vector< std::vector<uint64_t> > stableReceived; // Udp server counters at stableStart
+  bool done;
+
+  /* What finalResults needs when the run is shortened */
+  EventId finalEvent;
+  Ptr<OutputStreamWrapper> staStream;
+  std::vector<NodeContainer> sta;
+};
+struct cycle_skip skip;
+
 double
 GetJFI (int nStas, std::vector<uint64_t> &udpClientSentPackets)
 {
@@ -231,6 +660,332 @@ GetChannelForWifi (uint32_t ap, struct sim_config &config)
       return ch;   
 }
 
+/* Channel of a wlan once channelSetup has run */
+uint16_t
+GetWlanChannel (uint32_t wlan, struct sim_config &config)
+{
+  if (config.channelAllocation)
+    return GetChannelForWifi (wlan, config);
+  return config.channelNumber + 4 * wlan;
+}
+
+/* RNG stream of a component of node (0 is the AP) of a Wlan. The stream
+ * does not depend on the number of Wlans or Stas, or on the order in which
+ * the objects were created, so adding a node leaves the other nodes alone.
+ * Streams assigned this way stay below the ones ns-3 assigns automatically. */
+int64_t
+GetNodeStream (uint32_t wlan, uint32_t node, uint32_t component)
+{
+  NS_ASSERT (node < RNG_NODES && component < RNG_COMPONENTS);
+  return ((int64_t) wlan * RNG_NODES + node) * RNG_COMPONENTS + component;
+}
+
+void
+assignDeviceStreams (Ptr<NetDevice> device, uint32_t wlan, uint32_t node)
+{
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (device);
+  NS_ASSERT (wifi != 0);
+  int64_t streams = wifi->GetPhy ()->AssignStreams (GetNodeStream (wlan, node, RNG_PHY));
+  NS_ASSERT (streams == 1);
+
+  Ptr<RegularWifiMac> mac = DynamicCast<RegularWifiMac> (wifi->GetMac ());
+  NS_ASSERT (mac != 0);
+  streams = mac->GetDcaTxop ()->AssignStreams (GetNodeStream (wlan, node, RNG_DCA));
+  NS_ASSERT (streams == 1);
+  const char *queues[] = {"VO_EdcaTxopN", "VI_EdcaTxopN", "BE_EdcaTxopN", "BK_EdcaTxopN"};
+  for (uint32_t ac = 0; ac < 4; ac++)
+    {
+      PointerValue queue;
+      mac->GetAttribute (queues[ac], queue);
+      streams = queue.Get<EdcaTxopN> ()->AssignStreams (GetNodeStream (wlan, node, RNG_EDCA + ac));
+      NS_ASSERT (streams == 1);
+    }
+
+  Ptr<ApWifiMac> ap = DynamicCast<ApWifiMac> (mac);
+  if (ap != 0)
+    {
+      streams = ap->AssignStreams (GetNodeStream (wlan, node, RNG_BEACON));
+      NS_ASSERT (streams == 1);
+      streams = ap->GetBeaconDcaTxop ()->AssignStreams (GetNodeStream (wlan, node, RNG_BEACON_DCA));
+      NS_ASSERT (streams == 1);
+    }
+
+  Ptr<Node> n = device->GetNode ();
+  Ptr<MobilityModel> mobility = n->GetObject<MobilityModel> ();
+  if (mobility != 0)
+    {
+      streams = mobility->AssignStreams (GetNodeStream (wlan, node, RNG_MOBILITY));
+      NS_ASSERT (streams <= RNG_ARP - RNG_MOBILITY);
+    }
+  Ptr<ArpL3Protocol> arp = n->GetObject<ArpL3Protocol> ();
+  if (arp != 0)
+    {
+      streams = arp->AssignStreams (GetNodeStream (wlan, node, RNG_ARP));
+      NS_ASSERT (streams == 1);
+    }
+}
+
+/* Every channel takes the streams of the first AP that uses it */
+void
+assignNodeStreams (struct sim_config &config, std::vector<NetDeviceContainer> &staDevices,
+  std::vector<NetDeviceContainer> &apDevices)
+{
+  std::vector<Ptr<YansWifiChannel> > channels;
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      NS_ASSERT (staDevices.at (i).GetN () == config.nStas);
+      assignDeviceStreams (apDevices.at (i).Get (0), i, 0);
+      for (uint32_t j = 0; j < config.nStas; j++)
+        assignDeviceStreams (staDevices.at (i).Get (j), i, j + 1);
+
+      Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel> (apDevices.at (i).Get (0)->GetChannel ());
+      NS_ASSERT (channel != 0);
+      if (std::find (channels.begin (), channels.end (), channel) != channels.end ())
+        continue;
+      channels.push_back (channel);
+      int64_t streams = channel->AssignStreams (GetNodeStream (i, 0, RNG_LOSS));
+      NS_ASSERT (streams <= RNG_COMPONENTS - RNG_LOSS);
+    }
+}
+
+/* BSSs on the same channel are coupled by a propagation delay of tens of
+ * nanoseconds, so they share a logical process. BSSs on different channels
+ * exchange no frames over the air (YansWifiChannel::Send skips them), and
+ * with preassociate nothing crosses the bridged backbone either; the
+ * LpFilterScheduler aborts if something does. */
+void
+assignLogicalProcesses (struct sim_config &config)
+{
+  config.wlanLp.assign (config.nWifis, 0);
+  config.nLps = 1;
+  if (!config.partitions)
+    return;
+
+  std::map<uint16_t, uint32_t> channelLp;
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      uint16_t channel = GetWlanChannel (i, config);
+      std::map<uint16_t, uint32_t>::iterator it = channelLp.find (channel);
+      if (it == channelLp.end ())
+        {
+          uint32_t lp = channelLp.size ();
+          it = channelLp.insert (std::make_pair (channel, lp)).first;
+        }
+      config.wlanLp.at (i) = it->second;
+    }
+  config.nLps = channelLp.size ();
+}
+
+void
+reportLogicalProcesses (struct sim_config &config, std::vector<NodeContainer> &allNodes)
+{
+  std::cout << "-Logical processes: " << config.nLps << std::endl;
+  for (uint32_t lp = 0; lp < config.nLps; lp++)
+    {
+      std::cout << "\t- LP " << lp << ":";
+      for (uint32_t i = 0; i < config.nWifis; i++)
+        {
+          if (config.wlanLp.at (i) == lp)
+            std::cout << " wlan-" << i;
+        }
+      std::cout << std::endl;
+    }
+
+  /* The lookahead that splitting the co-channel BSSs would leave */
+  std::vector< std::vector<Ptr<MobilityModel> > > mobility (config.nWifis);
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      for (uint32_t n = 0; n < allNodes.at (i).GetN (); n++)
+        mobility.at (i).push_back (allNodes.at (i).Get (n)->GetObject<MobilityModel> ());
+    }
+  double minDistance = std::numeric_limits<double>::max ();
+  for (uint32_t a = 0; a < config.nWifis; a++)
+    {
+      for (uint32_t b = a + 1; b < config.nWifis; b++)
+        {
+          if (config.wlanLp.at (a) != config.wlanLp.at (b))
+            continue;
+          for (uint32_t na = 0; na < mobility.at (a).size (); na++)
+            {
+              for (uint32_t nb = 0; nb < mobility.at (b).size (); nb++)
+                minDistance = std::min (minDistance, mobility.at (a).at (na)->GetDistanceFrom (mobility.at (b).at (nb)));
+            }
+        }
+    }
+  if (minDistance == std::numeric_limits<double>::max ())
+    std::cout << "\t- No co-channel BSSs: every BSS is independent" << std::endl;
+  else
+    std::cout << "\t- Lookahead between co-channel BSSs: " << minDistance / 299792458.0 * 1e9 << " ns" << std::endl;
+}
+
+/* Parallel logical processes: each LP runs in a child process forked from
+ * the whole topology, right before Simulator::Run. Packets, their buffers
+ * and metadata keep free lists and reference counts that are not
+ * thread-safe, so the LPs cannot share an address space. */
+struct lp_process
+{
+  pid_t pid;
+  int fd;
+};
+
+/* Returns the LP to run in the child processes, and -1 in the parent */
+int32_t
+forkLogicalProcesses (struct sim_config &config, std::vector<struct lp_process> &children)
+{
+  /* Whatever is buffered would be written by every process */
+  std::cout.flush ();
+  std::cerr.flush ();
+  for (uint32_t lp = 0; lp < config.nLps; lp++)
+    {
+      int fds[2];
+      if (pipe (fds) != 0)
+        NS_FATAL_ERROR ("Could not create the pipe of LP " << lp << ": " << std::strerror (errno));
+      pid_t pid = fork ();
+      if (pid < 0)
+        NS_FATAL_ERROR ("Could not fork LP " << lp << ": " << std::strerror (errno));
+      if (pid == 0)
+        {
+          close (fds[0]);
+          for (uint32_t k = 0; k < children.size (); k++)
+            close (children.at (k).fd);
+          config.runLp = lp;
+          config.lpFd = fds[1];
+          return lp;
+        }
+      close (fds[1]);
+      struct lp_process child = {pid, fds[0]};
+      children.push_back (child);
+    }
+  return -1;
+}
+
+/* The traced logs of LP k go to <name>-lp<k> */
+void
+redirectLpLog (Ptr<OutputStreamWrapper> stream, std::string name, uint32_t lp)
+{
+  std::ostringstream lpName;
+  lpName << name << "-lp" << lp;
+  std::filebuf *file = new std::filebuf ();
+  if (file->open (lpName.str ().c_str (), std::ios::out) == 0)
+    NS_FATAL_ERROR ("Could not open " << lpName.str ());
+  stream->GetStream ()->flush ();
+  stream->GetStream ()->rdbuf (file);
+}
+
+/* Replaces finalResults in the child processes: one line per Wlan of the LP
+ * with the Udp server counters and the MAC counters of the AP and the Stas */
+void
+sendLpResults (struct sim_config &config, struct sim_results *results)
+{
+  std::ostringstream out;
+  out << "events " << Simulator::GetEventCount () << "\n";
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      if (config.wlanLp.at (i) != (uint32_t) config.runLp)
+        continue;
+      out << "wlan " << i;
+      for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+        out << " " << DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ();
+      for (uint32_t j = 0; j < results->nStas + 1; j++)
+        {
+          out << " " << results->failTx.at (i).at (j) << " " << results->colTx.at (i).at (j)
+            << " " << results->sxTx.at (i).at (j) << " " << results->txAttempts.at (i).at (j)
+            << " " << results->sumTimeBetweenSxTx.at (i).at (j).GetTimeStep ()
+            << " " << results->srAttempts.at (i).at (j) << " " << results->srReductions.at (i).at (j)
+            << " " << results->srFails.at (i).at (j);
+        }
+      out << "\n";
+    }
+
+  std::string data = out.str ();
+  size_t sent = 0;
+  while (sent < data.size ())
+    {
+      ssize_t n = write (config.lpFd, data.data () + sent, data.size () - sent);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        NS_FATAL_ERROR ("Could not send the results of LP " << config.runLp << ": " << std::strerror (errno));
+      sent += n;
+    }
+  close (config.lpFd);
+}
+
+/* Waits for every LP and adds its Wlans to the results. The Udp servers of
+ * the parent never run, so their frames are credited. Returns the events
+ * executed by all the LPs. */
+uint64_t
+mergeLpResults (struct sim_config &config, struct sim_results *results, std::vector<struct lp_process> &children)
+{
+  uint64_t events = 0;
+  std::vector<bool> reported (config.nWifis, false);
+  for (uint32_t lp = 0; lp < children.size (); lp++)
+    {
+      std::string data;
+      char buffer[4096];
+      ssize_t n;
+      while ((n = read (children.at (lp).fd, buffer, sizeof (buffer))) != 0)
+        {
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n < 0)
+            NS_FATAL_ERROR ("Could not read the results of LP " << lp << ": " << std::strerror (errno));
+          data.append (buffer, n);
+        }
+      close (children.at (lp).fd);
+
+      int status;
+      while (waitpid (children.at (lp).pid, &status, 0) < 0 && errno == EINTR);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        NS_FATAL_ERROR ("LP " << lp << " did not finish");
+
+      std::istringstream in (data);
+      std::string line;
+      while (std::getline (in, line))
+        {
+          std::istringstream row (line);
+          std::string tag;
+          row >> tag;
+          if (tag == "events")
+            {
+              uint64_t lpEvents;
+              row >> lpEvents;
+              events += lpEvents;
+              continue;
+            }
+          uint32_t i;
+          row >> i;
+          NS_ABORT_MSG_IF (row.fail () || i >= config.nWifis || config.wlanLp.at (i) != lp || reported.at (i),
+                           "LP " << lp << " sent an unexpected line: " << line);
+          reported.at (i) = true;
+          for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+            {
+              uint64_t received;
+              row >> received;
+              results->creditedPackets.at (i).at (j) += received;
+            }
+          for (uint32_t j = 0; j < results->nStas + 1; j++)
+            {
+              uint64_t failTx, colTx, sxTx, txAttempts, srAttempts, srReductions, srFails;
+              int64_t sumTime;
+              row >> failTx >> colTx >> sxTx >> txAttempts >> sumTime >> srAttempts >> srReductions >> srFails;
+              results->failTx.at (i).at (j) += failTx;
+              results->colTx.at (i).at (j) += colTx;
+              results->sxTx.at (i).at (j) += sxTx;
+              results->txAttempts.at (i).at (j) += txAttempts;
+              results->sumTimeBetweenSxTx.at (i).at (j) += TimeStep (sumTime);
+              results->srAttempts.at (i).at (j) += srAttempts;
+              results->srReductions.at (i).at (j) += srReductions;
+              results->srFails.at (i).at (j) += srFails;
+            }
+          NS_ABORT_MSG_IF (row.fail (), "LP " << lp << " sent a truncated line: " << line);
+        }
+    }
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    NS_ABORT_MSG_IF (!reported.at (i), "LP " << config.wlanLp.at (i) << " did not report wlan-" << i);
+  return events;
+}
+
 void
 channelSetup (struct sim_config &config, std::vector<NetDeviceContainer> staDevices, 
   std::vector<NetDeviceContainer> apDevices)
@@ -275,6 +1030,7 @@ channelSetup (struct sim_config &config, std::vector<NetDeviceContainer> staDevi
         {
           phyAp->SetChannelNumber (config.channelNumber + plus);
         }
+      NS_ASSERT (phyAp->GetChannelNumber () == GetWlanChannel (i, config));
 
 
       /* Setting the CCA parameters for AP */
@@ -394,6 +1150,11 @@ mobilityUsingBuildings (struct sim_config &config, std::vector<MobilityHelper> &
       
       Ptr<UniformRandomVariable> rX = CreateObject<UniformRandomVariable> ();
       Ptr<UniformRandomVariable> rY = CreateObject<UniformRandomVariable> ();
+      if (config.nodeStreams)
+        {
+          rX->SetStream (GetNodeStream (i, 0, RNG_POSITION));
+          rY->SetStream (GetNodeStream (i, 0, RNG_POSITION + 1));
+        }
 
       rX->SetAttribute ("Min", DoubleValue (wifiX));
       rX->SetAttribute ("Max", DoubleValue (wifiX + (2 * config.xDistanceFromAp)));
@@ -600,6 +1361,13 @@ mobilitySetup (struct sim_config &config, std::vector<MobilityHelper> &mobility,
 
 
       setupPositions:
+        /* The Stas of a Wlan keep their positions when Stas or Wlans are added */
+        if (config.nodeStreams)
+          {
+            rX->SetStream (GetNodeStream (i, 0, RNG_POSITION));
+            rY->SetStream (GetNodeStream (i, 0, RNG_POSITION + 1));
+            rZ->SetStream (GetNodeStream (i, 0, RNG_POSITION + 2));
+          }
         rX->SetAttribute ("Min", DoubleValue (wifiX - config.xDistanceFromAp));
         rX->SetAttribute ("Max", DoubleValue (wifiX + config.xDistanceFromAp));
         rY->SetAttribute ("Min", DoubleValue (-1.0 * config.yDistanceFromAp + wifiY));
@@ -714,6 +1482,125 @@ mobilitySetup (struct sim_config &config, std::vector<MobilityHelper> &mobility,
     }
 }
 
+/* Appends every address of the Ipv4 interface bound to device */
+void
+AddToArpTable (Ptr<NetDevice> device, ArpL3Protocol::ArpTable &table)
+{
+  Ptr<ArpL3Protocol> arp = device->GetNode ()->GetObject<ArpL3Protocol> ();
+  NS_ASSERT (arp);
+  Ptr<Ipv4Interface> iface = arp->FindCache (device)->GetInterface ();
+  for (uint32_t a = 0; a < iface->GetNAddresses (); a++)
+    table.push_back (std::make_pair (iface->GetAddress (a).GetLocal (), device->GetAddress ()));
+}
+
+void
+ProvisionArpCaches (NetDeviceContainer devices, const ArpL3Protocol::ArpTable &table)
+{
+  for (NetDeviceContainer::Iterator d = devices.Begin (); d != devices.End (); ++d)
+    (*d)->GetNode ()->GetObject<ArpL3Protocol> ()->ProvisionCache (*d, table);
+}
+
+void
+SetPeerCapabilities (Ptr<WifiRemoteStationManager> manager, Mac48Address peer, Ptr<RegularWifiMac> peerMac)
+{
+  /* Mirrors what Ap/StaWifiMac record from the (re)association exchange */
+  Ptr<WifiPhy> phy = peerMac->GetWifiPhy ();
+  bool ht = peerMac->GetHtSupported ();
+  bool vht = peerMac->GetVhtSupported ();
+
+  for (uint32_t m = 0; m < phy->GetNModes (); m++)
+    manager->AddSupportedMode (peer, phy->GetMode (m));
+
+  if (ht || vht)
+    {
+      HtCapabilities htCapabilities;
+      htCapabilities.SetHtSupported (1);
+      htCapabilities.SetLdpc (phy->GetLdpc ());
+      htCapabilities.SetSupportedChannelWidth (phy->GetChannelWidth () == 40);
+      htCapabilities.SetShortGuardInterval20 (phy->GetGuardInterval ());
+      htCapabilities.SetShortGuardInterval40 (phy->GetChannelWidth () == 40 && phy->GetGuardInterval ());
+      htCapabilities.SetGreenfield (phy->GetGreenfield ());
+      for (uint32_t m = 0; m < phy->GetNMcs (); m++)
+        htCapabilities.SetRxMcsBitmask (phy->GetMcs (m).GetMcsValue ());
+      manager->AddStationHtCapabilities (peer, htCapabilities);
+    }
+
+  if (vht)
+    {
+      VhtCapabilities vhtCapabilities;
+      uint8_t maxMcs = 0;
+      vhtCapabilities.SetVhtSupported (1);
+      vhtCapabilities.SetSupportedChannelWidthSet (phy->GetChannelWidth () == 160);
+      vhtCapabilities.SetRxLdpc (phy->GetLdpc ());
+      vhtCapabilities.SetShortGuardIntervalFor80Mhz ((phy->GetChannelWidth () == 80) && phy->GetGuardInterval ());
+      vhtCapabilities.SetShortGuardIntervalFor160Mhz ((phy->GetChannelWidth () == 160) && phy->GetGuardInterval ());
+      for (uint32_t m = 0; m < phy->GetNMcs (); m++)
+        maxMcs = std::max (maxMcs, phy->GetMcs (m).GetMcsValue ());
+      vhtCapabilities.SetRxMcsMap (maxMcs, 1);
+      vhtCapabilities.SetTxMcsMap (maxMcs, 1);
+      manager->AddStationVhtCapabilities (peer, vhtCapabilities);
+    }
+
+  for (uint32_t m = 0; m < phy->GetNMcs (); m++)
+    {
+      WifiMode mcs = phy->GetMcs (m);
+      if ((ht && mcs.GetModulationClass () == WIFI_MOD_CLASS_HT)
+          || (vht && mcs.GetModulationClass () == WIFI_MOD_CLASS_VHT))
+        manager->AddSupportedMcs (peer, mcs);
+    }
+}
+
+/* Installs the state the association handshake, ARP and ADDBA exchanges
+ * would have produced, so that traffic can start at t=0. Must run after
+ * channelSetup so capabilities reflect the final channel width. */
+void
+preassociateWlans (struct sim_config &config, std::vector<NetDeviceContainer> staDevices,
+  std::vector<NetDeviceContainer> apDevices)
+{
+  NS_ASSERT (config.nWifis == staDevices.size ());
+  NS_ASSERT (apDevices.size () == config.nWifis);
+
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      Ptr<WifiNetDevice> apDevice = DynamicCast<WifiNetDevice> (apDevices.at (i).Get (0));
+      NS_ASSERT (apDevice);
+      Ptr<RegularWifiMac> apMac = apDevice->GetMac ()->GetObject<RegularWifiMac> ();
+      Ptr<WifiRemoteStationManager> apManager = apDevice->GetRemoteStationManager ();
+      Mac48Address apAddress = apMac->GetAddress ();
+
+      ArpL3Protocol::ArpTable arpTable;
+      AddToArpTable (apDevice, arpTable);
+
+      uint32_t nStas = staDevices.at (i).GetN ();
+      for (uint32_t j = 0; j < nStas; j++)
+        {
+          Ptr<WifiNetDevice> staDevice = DynamicCast<WifiNetDevice> (staDevices.at (i).Get (j));
+          NS_ASSERT (staDevice);
+          Ptr<RegularWifiMac> staMac = staDevice->GetMac ()->GetObject<RegularWifiMac> ();
+          Mac48Address staAddress = staMac->GetAddress ();
+
+          /* AP side: the STA is associated */
+          SetPeerCapabilities (apManager, staAddress, staMac);
+          apManager->RecordWaitAssocTxOk (staAddress);
+          apManager->RecordGotAssocTxOk (staAddress);
+
+          /* STA side: BSSID and the AP capabilities */
+          staMac->SetBssid (apAddress);
+          SetPeerCapabilities (staDevice->GetRemoteStationManager (), apAddress, apMac);
+
+          /* Uplink block ack agreement, only used with A-MPDU */
+          if (config.fairShareAMPDU)
+            staMac->InstallBlockAckAgreement (apMac, 0);
+
+          AddToArpTable (staDevice, arpTable);
+        }
+
+      /* One (IP, MAC) table per WLAN, installed at once in every member */
+      NetDeviceContainer wlanDevices (apDevices.at (i), staDevices.at (i));
+      ProvisionArpCaches (wlanDevices, arpTable);
+    }
+}
+
 void
 finishSetup (struct sim_config &config, std::vector<NodeContainer> allNodes)
 {
@@ -727,33 +1614,23 @@ finishSetup (struct sim_config &config, std::vector<NodeContainer> allNodes)
       NS_ASSERT (allNodes.at (i).GetN () == config.nStas);
       uint32_t device = 1; // device for stas
 
-      /* Navigating through stations for providing Arp entries */
+      /* Providing Arp entries: one table per WLAN, installed in bulk */
       uint32_t nStas = allNodes.at (i).GetN ();
-      for (uint32_t j = 0; j < nStas; j++)
+      if (!config.preassociate) // preassociateWlans already did it
         {
-          for (uint32_t k = 0; k < nStas; k++)
+          NetDeviceContainer wlanDevices;
+          ArpL3Protocol::ArpTable arpTable;
+          for (uint32_t j = 0; j < nStas; j++)
             {
-              if (k == j)        
-                continue;          
-              /* Getting arpCache of node j */
-              Ptr<NetDevice> netDeviceJ = allNodes.at (i).Get (j)->GetDevice (device)->GetObject<NetDevice> ();
-              Ptr<ArpCache> arpCacheJ = allNodes.at (i).Get (j)->GetObject<ArpL3Protocol> ()->FindCache (netDeviceJ);
-              if (arpCacheJ == NULL)
-                arpCacheJ = CreateObject<ArpCache> ();
-
-              /* Getting the addresses of node k */
-              Ptr<WifiNetDevice> wifiNetDeviceK = allNodes.at (i).Get (k)->GetDevice (device)->GetObject<WifiNetDevice> ();
-              Address mac = wifiNetDeviceK->GetAddress ();
-
-              Ptr<ArpCache> arpCacheK = allNodes.at (i).Get (k)->GetObject<ArpL3Protocol> ()->FindCache (wifiNetDeviceK);
-              Ptr<Ipv4Interface> ipv4InterfaceK = arpCacheK->GetInterface ();
-              Ipv4Address ip = ipv4InterfaceK->GetAddress (0).GetLocal ();
-              arpCacheJ->SetAliveTimeout (Seconds (config.simulationTime + 1));
-              ArpCache::Entry *entry = arpCacheJ->Add (ip);
-              entry->MarkWaitReply(0);
-              entry->MarkAlive(mac);
+              Ptr<NetDevice> netDevice = allNodes.at (i).Get (j)->GetDevice (device);
+              AddToArpTable (netDevice, arpTable);
+              wlanDevices.Add (netDevice);
             }
+          ProvisionArpCaches (wlanDevices, arpTable);
+        }
 
+      for (uint32_t j = 0; j < nStas; j++)
+        {
           Ptr<EdcaTxopN> edca = allNodes.at (i).Get (j)->GetDevice (device)->GetObject<WifiNetDevice> ()->GetMac ()
                                 ->GetObject<RegularWifiMac> ()->GetBEQueue ();
           NS_ASSERT (edca);
@@ -775,8 +1652,17 @@ finishSetup (struct sim_config &config, std::vector<NodeContainer> allNodes)
                     edca->SetScheduleConservative (); //Determines gamma. Default is aggressive gamma = 1, actual value is 2 though.
                   if (config.srResetMode)
                     edca->SetScheduleResetMode (); //Halving or reset?
+                  if (config.srWindow > 0)
+                    edca->SetScheduleReductionWindow (config.srWindow);
                 }
 
+              if (config.ecaController)
+                edca->SetEcaController (config.targetEmptySlots, config.targetCollisions,
+                                       config.controllerWindow, config.controllerMaxStickiness);
+
+              if (config.rtsSuppression > 0)
+                edca->SetEcaRtsSuppression (config.rtsSuppression);
+
               if (config.fairShare)
                 {
                   edca->SetFairShare ();
@@ -801,17 +1687,150 @@ finishSetup (struct sim_config &config, std::vector<NodeContainer> allNodes)
         std::cout << "\t- CSMA/ECA: " << config.eca << std::endl;
         std::cout << "\t- Hysteresis: " << config.hysteresis << std::endl;
         std::cout << "\t\t- Stickiness: " << config.stickiness << std::endl;
+        std::cout << "\t\t- Controller: " << config.ecaController << std::endl;
+        if (config.ecaController)
+          std::cout << "\t\t\t- Window: " << config.controllerWindow << ", max stickiness: "
+            << config.controllerMaxStickiness << std::endl;
         std::cout << "\t- FairShare: " << config.fairShare << std::endl;
         std::cout << "\t- FairShare AMPDU: " << config.fairShareAMPDU << std::endl;
         std::cout << "\t- Schedule Reduction: " << config.bitmap << std::endl;
         std::cout << "\t\t- srConservative: " << config.srConservative << std::endl;
         std::cout << "\t\t- srResetMode: " << config.srResetMode << std::endl;
+        std::cout << "\t\t- srWindow: " << config.srWindow << std::endl;
 
         std::cout << "\t- CwMin: " << CwMin << std::endl;
         std::cout << "\t- CwMax: " << CwMax << std::endl;
     }
 }
 
+/* Writes the CSMA/ECA state of every STA, one line per STA:
+ * wlan sta cw backoffSlots consecutiveSuccess srThreshold srBeingFilled srIterations
+ * srReductionFactor srRecentlyReduced srPreviousCw stickiness fillingBitmap bitmapSize bits... */
+void
+saveEcaState (struct sim_config &config, std::string fileName, std::vector<NodeContainer> allNodes)
+{
+  NS_ASSERT (config.nWifis == allNodes.size ());
+  std::ofstream out (fileName.c_str ());
+  NS_ABORT_MSG_IF (!out.is_open (), "Cannot open " << fileName);
+
+  uint32_t device = 1; // device for stas
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      for (uint32_t j = 0; j < allNodes.at (i).GetN (); j++)
+        {
+          Ptr<RegularWifiMac> mac = allNodes.at (i).Get (j)->GetDevice (device)->GetObject<WifiNetDevice> ()->GetMac ()
+                                    ->GetObject<RegularWifiMac> ();
+          EcaTxopSnapshot txop = mac->GetBEQueue ()->GetEcaSnapshot ();
+          DcfManagerEcaSnapshot manager = mac->GetDcfManager ()->GetEcaSnapshot ();
+
+          out << i << " " << j << " " << txop.dcf.cw << " " << txop.dcf.backoffSlots << " "
+              << txop.consecutiveSuccess << " " << txop.scheduleResetThreshold << " "
+              << txop.srBeingFilled << " " << txop.srIterations << " " << txop.srReductionFactor << " "
+              << txop.scheduleRecentlyReduced << " " << txop.srPreviousCw << " "
+              << manager.stickiness << " " << txop.dcf.fillingTheBitmap << " " << txop.dcf.bitmap.size ();
+          for (uint32_t b = 0; b < txop.dcf.bitmap.size (); b++)
+            out << " " << txop.dcf.bitmap.at (b);
+          out << std::endl;
+        }
+    }
+  NS_ABORT_MSG_IF (out.fail (), "Could not write the CSMA/ECA state to " << fileName);
+  std::cout << "Saved CSMA/ECA state at " << Simulator::Now ().GetSeconds () << "s to " << fileName << std::endl;
+}
+
+/* Restores the state written by saveEcaState. Must run after finishSetup,
+ * right when traffic starts: idle slots before that would consume the
+ * restored backoff. The scenario (nWifis, nStas, protocol flags) must match
+ * the one that saved the state. */
+void
+loadEcaState (struct sim_config &config, std::string fileName, std::vector<NodeContainer> allNodes)
+{
+  NS_ASSERT (config.nWifis == allNodes.size ());
+  std::ifstream in (fileName.c_str ());
+  NS_ABORT_MSG_IF (!in.is_open (), "Cannot open " << fileName);
+
+  uint32_t device = 1; // device for stas
+  uint32_t restored = 0;
+  uint32_t lineNumber = 0;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      lineNumber++;
+      std::istringstream fields (line);
+      uint32_t i, j, bitmapSize;
+      EcaTxopSnapshot txop;
+      DcfManagerEcaSnapshot manager;
+
+      if (line.find_first_not_of (" \t\r") == std::string::npos)
+        continue;
+      fields >> i >> j >> txop.dcf.cw >> txop.dcf.backoffSlots
+             >> txop.consecutiveSuccess >> txop.scheduleResetThreshold
+             >> txop.srBeingFilled >> txop.srIterations >> txop.srReductionFactor
+             >> txop.scheduleRecentlyReduced >> txop.srPreviousCw
+             >> manager.stickiness >> txop.dcf.fillingTheBitmap >> bitmapSize;
+      NS_ABORT_MSG_IF (fields.fail (), fileName << ":" << lineNumber << ": malformed CSMA/ECA state");
+      for (uint32_t b = 0; b < bitmapSize; b++)
+        {
+          bool bit;
+          fields >> bit;
+          NS_ABORT_MSG_IF (fields.fail (), fileName << ":" << lineNumber << ": expected " << bitmapSize
+                           << " bitmap bits, found " << b);
+          txop.dcf.bitmap.push_back (bit);
+        }
+      NS_ABORT_MSG_IF (i >= config.nWifis || j >= allNodes.at (i).GetN (),
+                       "State for " << i << "->" << j << " does not match the topology");
+
+      Ptr<RegularWifiMac> mac = allNodes.at (i).Get (j)->GetDevice (device)->GetObject<WifiNetDevice> ()->GetMac ()
+                                ->GetObject<RegularWifiMac> ();
+      mac->GetBEQueue ()->RestoreEcaSnapshot (txop);
+      mac->GetDcfManager ()->RestoreEcaSnapshot (manager);
+      restored++;
+    }
+  NS_ABORT_MSG_IF (restored != config.nWifis * config.nStas,
+                   "Restored " << restored << " stations from " << fileName << ", the topology has "
+                   << config.nWifis * config.nStas);
+  std::cout << "Restored CSMA/ECA state of " << restored << " stations from " << fileName << std::endl;
+}
+
+/* Starts the slot statistics window of the first Sta of every Wlan */
+void
+startSlotStats (struct sim_config &config, std::vector<NodeContainer> allNodes)
+{
+  uint32_t device = 1; // device for stas
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      Ptr<DcfManager> manager = allNodes.at (i).Get (0)->GetDevice (device)->GetObject<WifiNetDevice> ()
+                                ->GetMac ()->GetObject<RegularWifiMac> ()->GetDcfManager ();
+      manager->EnableSlotHistograms (config.slotHistogramBins);
+      manager->ResetSlotStats ();
+    }
+}
+
+void
+printSlotStats (Ptr<DcfManager> manager)
+{
+  DcfSlotStats stats = manager->GetSlotStats ();
+  double slots = stats.idleSlots + stats.successPeriods + stats.collisionPeriods + stats.otherPeriods;
+  if (slots == 0)
+    return;
+  std::cout << "-Slots (first Sta): " << slots << std::endl;
+  std::cout << "\tEmpty: " << stats.idleSlots / slots << std::endl;
+  std::cout << "\tSuccessful: " << stats.successPeriods / slots << std::endl;
+  std::cout << "\tCollisions: " << stats.collisionPeriods / slots << std::endl;
+  std::cout << "\tOther: " << stats.otherPeriods / slots << std::endl;
+  std::cout << "\tOwn transmissions: " << stats.ownTransmissions << std::endl;
+  std::cout << "\tBusy time: " << stats.busyTime.GetSeconds () << " s" << std::endl;
+  if (!stats.idleRunHistogram.empty ())
+    {
+      std::cout << "\tIdle runs (slots):";
+      for (uint32_t b = 0; b < stats.idleRunHistogram.size (); b++)
+        std::cout << " " << stats.idleRunHistogram.at (b);
+      std::cout << std::endl << "\tBusy periods (slots):";
+      for (uint32_t b = 0; b < stats.busyLengthHistogram.size (); b++)
+        std::cout << " " << stats.busyLengthHistogram.at (b);
+      std::cout << std::endl;
+    }
+}
+
 void
 finalResults (struct sim_config &config, Ptr<OutputStreamWrapper> stream, struct sim_results *results, 
   Ptr<OutputStreamWrapper> staStream, std::vector<NodeContainer> sta)
@@ -861,8 +1880,9 @@ finalResults (struct sim_config &config, Ptr<OutputStreamWrapper> stream, struct
       NS_ASSERT (config.servers.at (i).GetN () == sta.at (i).GetN ());
       for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
         {
-          uint32_t totalPacketsThrough = DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ();
-          double addThroughput = totalPacketsThrough * config.payloadSize * 8 / (config.simulationTime * 1000000.0);
+          uint64_t totalPacketsThrough = DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ()
+                                         + results->creditedPackets.at (i).at (j);
+          double addThroughput = totalPacketsThrough * config.payloadSize * 8 / (results->elapsedTime * 1000000.0);
           throughput += addThroughput;
           std::cout << "\t-Sta-" << j << ": " << addThroughput << " Mbps" << std::endl;
           results->udpClientSentPackets.at (i).at (j) = totalPacketsThrough;
@@ -927,6 +1947,9 @@ finalResults (struct sim_config &config, Ptr<OutputStreamWrapper> stream, struct
         std::cout << "-Total Tx Attmpts: " << attempts << std::endl;
         std::cout << "-Total Sx Frames: " << sx << std::endl;
         std::cout << "-Total Failures: " << totalFails << std::endl;
+        if (config.slotStats)
+          printSlotStats (sta.at (i).Get (0)->GetDevice (1)->GetObject<WifiNetDevice> ()
+                          ->GetMac ()->GetObject<RegularWifiMac> ()->GetDcfManager ());
 
         /* Global stats */
         topologyThroughput.at (i) = throughput;
@@ -957,11 +1980,183 @@ finalResults (struct sim_config &config, Ptr<OutputStreamWrapper> stream, struct
            4. JFI
            5. Time bet sx tx
            6. txAttempts
+           7. Simulated time (only with the convergence monitor)
+           8. Stop reason (only with the convergence monitor)
          */
         *results->results_stream->GetStream () << i << " " << results->nStas << " " << topologyThroughput.at (i) << " "
           << topologyFailedTx.at (i) << " " << topologyJFI.at (i) << " " << overallTimeBetweenSxTx.at (i) 
-          << " " << topologyTxAttempts.at (i) << std::endl;
+          << " " << topologyTxAttempts.at (i);
+        if (config.convergence)
+          *results->results_stream->GetStream () << " " << results->elapsedTime << " " << results->stopReason;
+        *results->results_stream->GetStream () << std::endl;
       }
+    if (config.convergence)
+      std::cout << "\n- Stopped after " << results->elapsedTime << " s: "
+        << (results->stopReason == STOP_CONVERGED ? "converged" : "simulationTime reached") << std::endl;
+    if (results->skippedCycles > 0)
+      std::cout << "\n- Skipped " << results->skippedCycles << " collision-free cycles ("
+        << results->skippedTime << " s)" << std::endl;
+}
+
+/* Samples one window of throughput, fraction of failed transmissions and JFI
+ * of the whole topology. Once the confidence interval of the three of them is
+ * narrow enough, results are written and the simulation stops. */
+void
+checkConvergence (struct sim_config &config, struct sim_results *results, struct convergence_monitor *monitor)
+{
+  uint64_t sx = 0;
+  uint64_t failed = 0;
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      for (uint32_t j = 0; j < results->nStas + 1; j++)
+        {
+          sx += results->sxTx.at (i).at (j);
+          failed += results->failTx.at (i).at (j) + results->colTx.at (i).at (j);
+        }
+    }
+
+  double throughput = 0.0;
+  double jfi = 0.0;
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      double sum = 0.0;
+      double sumSquares = 0.0;
+      for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+        {
+          uint64_t received = DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ();
+          double delta = received - monitor->lastReceived.at (i).at (j);
+          monitor->lastReceived.at (i).at (j) = received;
+          sum += delta;
+          sumSquares += delta * delta;
+        }
+      throughput += sum * config.payloadSize * 8 / (config.convergenceWindow * 1000000.0);
+      if (sumSquares > 0)
+        jfi += sum * sum / (config.servers.at (i).GetN () * sumSquares);
+    }
+  jfi /= config.nWifis;
+
+  double failFrac = 0.0;
+  uint64_t windowSx = sx - monitor->lastSx;
+  uint64_t windowFailed = failed - monitor->lastFailed;
+  if (windowSx + windowFailed > 0)
+    failFrac = double (windowFailed) / (windowSx + windowFailed);
+  monitor->lastSx = sx;
+  monitor->lastFailed = failed;
+
+  AddSample (monitor->throughput, throughput);
+  AddSample (monitor->failFrac, failFrac);
+  AddSample (monitor->jfi, jfi);
+
+  bool converged = monitor->throughput.n >= config.convergenceMinWindows
+                   && GetCiHalfWidth (monitor->throughput) <= config.convergenceCi * monitor->throughput.mean
+                   && GetCiHalfWidth (monitor->failFrac) <= config.convergenceCi
+                   && GetCiHalfWidth (monitor->jfi) <= config.convergenceCi;
+
+  if (converged)
+    {
+      results->elapsedTime = Simulator::Now ().GetSeconds () - config.startTime;
+      results->stopReason = STOP_CONVERGED;
+      Simulator::Cancel (monitor->finalEvent);
+      finalResults (config, results->results_stream, results, monitor->staStream, monitor->sta);
+      Simulator::Stop ();
+      return;
+    }
+
+  Simulator::Schedule (Seconds (config.convergenceWindow), checkConvergence, config, results, monitor);
+}
+
+void
+cycleSkipReadServers (struct sim_config &config, std::vector< std::vector<uint64_t> > &received)
+{
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+      received.at (i).at (j) = DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ();
+}
+
+/* A failure, collision or schedule reduction: the schedule is not stable */
+void
+cycleSkipPerturbation (struct cycle_skip *skip)
+{
+  skip->active = false;
+  skip->stableCycles = 0;
+}
+
+/* Credits the whole cycles left until simulationTime with the successes and
+ * Udp packets of the stable cycles, and simulates only what remains of the
+ * last one. */
+void
+cycleSkipAdvance (struct sim_config &config, struct sim_results *results, struct cycle_skip *skip)
+{
+  skip->done = true;
+  Time now = Simulator::Now ();
+  uint64_t period = (now - skip->stableStart).GetNanoSeconds () / skip->stableCycles;
+  Time left = Seconds (config.startTime + config.simulationTime) - now;
+  if (period == 0 || left.GetNanoSeconds () < (int64_t) period)
+    return;
+  uint64_t n = left.GetNanoSeconds () / period;
+
+  std::vector< std::vector<uint64_t> > received = skip->stableReceived;
+  cycleSkipReadServers (config, received);
+  for (uint32_t i = 0; i < config.nWifis; i++)
+    {
+      for (uint32_t j = 0; j < results->nStas + 1; j++)
+        {
+          uint64_t sx = n * skip->pattern.at (i).at (j);
+          results->sxTx.at (i).at (j) += sx;
+          results->txAttempts.at (i).at (j) += sx;
+          if (sx > 0)
+            results->sumTimeBetweenSxTx.at (i).at (j) += NanoSeconds (n * period);
+        }
+      for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+        results->creditedPackets.at (i).at (j) = (received.at (i).at (j) - skip->stableReceived.at (i).at (j))
+                                                 * n / skip->stableCycles;
+    }
+  results->skippedCycles = n;
+  results->skippedTime = NanoSeconds (n * period).GetSeconds ();
+
+  Time remaining = left - NanoSeconds (n * period);
+  Simulator::Cancel (skip->finalEvent);
+  Simulator::Schedule (Max (remaining - MicroSeconds (1), Seconds (0)), finalResults, config,
+                       results->results_stream, results, skip->staStream, skip->sta);
+  Simulator::Stop (remaining);
+}
+
+void
+cycleSkipSuccess (struct sim_config &config, struct sim_results *results, struct cycle_skip *skip,
+                  uint32_t wlan, uint32_t node)
+{
+  if (skip->done)
+    return;
+  if (skip->active && wlan == skip->anchorWlan && node == skip->anchorNode)
+    {
+      if (skip->stableCycles > 0 && skip->current == skip->pattern)
+        {
+          skip->stableCycles++;
+        }
+      else
+        {
+          skip->pattern = skip->current;
+          skip->stableCycles = 1;
+          skip->stableStart = skip->cycleStart;
+          skip->stableReceived = skip->cycleReceived;
+        }
+      if (skip->stableCycles >= config.cycleSkipCycles)
+        {
+          cycleSkipAdvance (config, results, skip);
+          return;
+        }
+    }
+  if (!skip->active || (wlan == skip->anchorWlan && node == skip->anchorNode))
+    {
+      skip->active = true;
+      skip->anchorWlan = wlan;
+      skip->anchorNode = node;
+      skip->cycleStart = Simulator::Now ();
+      cycleSkipReadServers (config, skip->cycleReceived);
+      for (uint32_t i = 0; i < skip->current.size (); i++)
+        std::fill (skip->current.at (i).begin (), skip->current.at (i).end (), 0);
+    }
+  skip->current.at (wlan).at (node)++;
 }
 
 void
@@ -979,6 +2174,8 @@ TraceFailures(Ptr<OutputStreamWrapper> stream, struct sim_results *results, std:
 
   results->failTx.at (std::stoi (wlan)).at (std::stoi (node)) ++;
   results->lastFailure = m_now;
+  if (config.cycleSkip)
+    cycleSkipPerturbation (&skip);
 }
 
 void
@@ -996,6 +2193,8 @@ TraceCollisions(Ptr<OutputStreamWrapper> stream, struct sim_results *results, st
 
   results->colTx.at (std::stoi (wlan)).at (std::stoi (node)) ++;
   results->lastCollision = m_now;
+  if (config.cycleSkip)
+    cycleSkipPerturbation (&skip);
 }
 
 void
@@ -1019,6 +2218,8 @@ TraceSuccesses(Ptr<OutputStreamWrapper> stream, struct sim_results *results, std
   delta = (m_now - results->timeOfPrevSxTx.at (std::stoi (wlan)).at (std::stoi (node)).GetNanoSeconds ());
   results->sumTimeBetweenSxTx.at (std::stoi (wlan)).at (std::stoi (node)) += NanoSeconds (delta);
   results->timeOfPrevSxTx.at (std::stoi (wlan)).at (std::stoi (node)) = NanoSeconds (m_now);
+  if (config.cycleSkip)
+    cycleSkipSuccess (config, results, &skip, std::stoi (wlan), std::stoi (node));
 }
 
 void
@@ -1090,6 +2291,8 @@ TraceSrReductions(Ptr<OutputStreamWrapper> stream, struct sim_results *results,
 
   *stream->GetStream () << m_now << " " << wlan << " " << node << " " << SXTX << " " << newValue << std::endl; 
   results->srReductions.at (std::stoi (wlan)).at (std::stoi (node))++;
+  if (config.cycleSkip)
+    cycleSkipPerturbation (&skip);
 }
 
 void
@@ -1121,12 +2324,17 @@ TraceFsAggregated(Ptr<OutputStreamWrapper> stream, std::string context, uint16_t
 
 int main (int argc, char *argv[])
 {
+  SystemWallClockMs wallClock;
+  wallClock.Start ();
   uint32_t nWifis = 1;
   uint32_t nStas = 2;
   bool sendIp = false;
   uint32_t channelWidth = 20;
   uint16_t channelNumber = 40;
   bool channelAllocation = false;
+  bool partitions = false;
+  bool parallel = false;
+  bool nodeStreams = false;
   double freq = 5.240e9;
   bool writeMobility = false;
   double deltaWifiX = 30.0;
@@ -1141,16 +2349,25 @@ int main (int argc, char *argv[])
   bool randomWalk = false;
   uint32_t payloadSize = 1470; //bytesq
   bool enableRts = false;
+  uint32_t rtsSuppression = 0;
   int32_t seed = -1;
   uint32_t destPort = 1000;
   uint64_t simulationTime = 3; //seconds
   uint32_t txRate = 83;
+  bool downlink = false;
+  double downlinkQuantum = 0; //microseconds
   Time dataGenerationRate = Seconds ((payloadSize*8) / (txRate * 1e6));
   bool saturation = true;
   bool verbose = false;
   uint32_t defaultPositions = 0;
   bool srResetMode = false;
   bool srConservative = false;
+  uint32_t srWindow = 0;
+  bool ecaController = false;
+  double targetEmptySlots = 0.5;
+  double targetCollisions = 0.05;
+  uint32_t controllerWindow = 100;
+  int32_t maxStickiness = -1;
 
   /* Mobility */
   double xDistanceFromAp = 10; // x component of maxWifiRange calculation
@@ -1171,6 +2388,31 @@ int main (int argc, char *argv[])
   bool dynStick = false;
   uint32_t stickiness = 0;
 
+  /* Beacon model */
+  bool cacheBeacon = false;
+  bool beaconAirtimeOnly = false;
+  bool slotStats = false;
+  uint32_t slotHistogramBins = 0;
+
+  /* Startup */
+  bool preassociate = false;
+  std::string saveState ("");
+  std::string loadState ("");
+  double warmup = 0.0;
+
+  /* Convergence monitor */
+  bool convergence = false;
+  double convergenceWindow = 0.1; //seconds
+  double convergenceCi = 0.01;
+  uint32_t convergenceMinWindows = 10;
+
+  /* Cycle skipping */
+  bool cycleSkip = false;
+  uint32_t cycleSkipCycles = 20;
+
+  std::string benchmark ("");
+  bool profileEvents = false;
+  double profileInterval = 0; //seconds
   std::string resultsName ("results3.log");
   std::string staResultsName ("staResults3.log");
   std::string txLog ("tx.log");
@@ -1197,19 +2439,75 @@ int main (int argc, char *argv[])
   cmd.AddValue ("verbose", "Logging", verbose);
   cmd.AddValue ("srResetMode", "By default, schedules will be halved. Set true for Schedule Reset", srResetMode);
   cmd.AddValue ("srConservative", "Adjusts the number of iterations for building Schedule Reset bitmap", srConservative);
+  cmd.AddValue ("srWindow", "Check Schedule Reset after every success over the last srWindow cycles (0: fill/check rounds)", srWindow);
   cmd.AddValue ("eca", "Activation of a deterministic backoff after sxTx", eca);
   cmd.AddValue ("hyst", "Hysteresis", hysteresis);
   cmd.AddValue ("stickiness", "Stickiness", stickiness);
   cmd.AddValue ("fairShare", "Fair Share", fairShare);
   cmd.AddValue ("bitmap", "Bitmap activation", bitmap);
   cmd.AddValue ("dynStick", "Dynamic stickiness", dynStick);
+  cmd.AddValue ("ecaController", "Adapt stickiness and CW to the observed empty slots and failures", ecaController);
+  cmd.AddValue ("targetEmptySlots", "Empty slot fraction above which the controller drops a CW stage", targetEmptySlots);
+  cmd.AddValue ("targetCollisions", "Failure rate above which the controller lowers stickiness", targetCollisions);
+  cmd.AddValue ("controllerWindow", "Transmissions between two decisions of the controller", controllerWindow);
+  cmd.AddValue ("maxStickiness", "Highest stickiness the controller may choose (-1: stickiness + 1)", maxStickiness);
+  cmd.AddValue ("enableRts", "Protect every data frame with RTS/CTS", enableRts);
+  cmd.AddValue ("rtsSuppression", "Switch RTS/CTS off after this many collision-free CSMA/ECA successes (0: never)", rtsSuppression);
   cmd.AddValue ("edTheshold", "Energy detection threshold", edTheshold);
   cmd.AddValue ("cca1Threshold", "CCA threshold", cca1Threshold);
   cmd.AddValue ("fairShareAMPDU", "Fair Share at AMPDU level", fairShareAMPDU);
   cmd.AddValue ("saturation", "Maximum packet generation rate", saturation);
+  cmd.AddValue ("downlink", "Udp flows from the Ap to each Sta instead of from each Sta to the Ap", downlink);
+  cmd.AddValue ("downlinkQuantum", "Microseconds of airtime per round robin turn of each Sta at the Ap (0: queue order)", downlinkQuantum);
   cmd.AddValue ("channelAllocation", "Separate nWiFis in orthogonal channels", channelAllocation);
+  cmd.AddValue ("partitions", "Group the BSSs by channel in logical processes with a YansWifiChannel each", partitions);
+  cmd.AddValue ("parallel", "Run each logical process of partitions in its own process (traced logs to <log>-lp<k>)", parallel);
+  cmd.AddValue ("nodeStreams", "Key the RNG streams by Wlan, node and component instead of creation order", nodeStreams);
+  cmd.AddValue ("preassociate", "Install association, ARP and block ack state and start traffic at t=0", preassociate);
+  cmd.AddValue ("saveState", "Save the CSMA/ECA state of the stations to this file after warmup", saveState);
+  cmd.AddValue ("warmup", "Seconds of traffic before saving the CSMA/ECA state", warmup);
+  cmd.AddValue ("loadState", "Start traffic from the CSMA/ECA state saved in this file", loadState);
+  cmd.AddValue ("convergence", "Stop before simulationTime once throughput, failures and JFI converge", convergence);
+  cmd.AddValue ("convergenceWindow", "Seconds per convergence sample", convergenceWindow);
+  cmd.AddValue ("convergenceCi", "Target 95% CI half-width (relative for throughput)", convergenceCi);
+  cmd.AddValue ("convergenceMinWindows", "Minimum samples before stopping", convergenceMinWindows);
+  cmd.AddValue ("cycleSkip", "Extrapolate the run once CSMA/ECA repeats a collision-free schedule", cycleSkip);
+  cmd.AddValue ("cycleSkipCycles", "Identical collision-free cycles before skipping", cycleSkipCycles);
+  cmd.AddValue ("benchmark", "Append the run time, events and memory of this run to this file", benchmark);
+  cmd.AddValue ("profileEvents", "Report the events and wall time of each type of scheduled callback", profileEvents);
+  cmd.AddValue ("profileInterval", "Seconds between the partial reports of profileEvents (0: only at the end)", profileInterval);
+  cmd.AddValue ("cacheBeacon", "Build the beacon of each AP only once", cacheBeacon);
+  cmd.AddValue ("slotStats", "Print the empty/successful/collision slot ratios seen by the first Sta of each Wlan", slotStats);
+  cmd.AddValue ("slotHistogramBins", "Bins of the idle run and busy period histograms of slotStats", slotHistogramBins);
+  cmd.AddValue ("beaconAirtimeOnly", "Beacons from other BSSs only occupy the medium", beaconAirtimeOnly);
   cmd.Parse (argc, argv);
 
+  /* The per process results only hold the counters of the Wlans. Without
+   * preassociate, ARP requests are flooded to every BSS through the
+   * backbone, so the logical processes are not independent */
+  if (parallel && (!partitions || !preassociate || convergence || cycleSkip || !saveState.empty () || slotStats))
+    {
+      std::cout << "parallel needs partitions and preassociate, and no convergence monitor, cycleSkip, saveState "
+        << "or slotStats: running sequentially" << std::endl;
+      parallel = false;
+    }
+
+  /* Before the first use of the simulator */
+  if (profileEvents)
+    {
+      GlobalValue::Bind ("SchedulerType", StringValue ("ns3::EventProfilingScheduler"));
+      Config::SetDefault ("ns3::EventProfilingScheduler::SnapshotInterval", TimeValue (Seconds (profileInterval)));
+    }
+  if (parallel)
+    {
+      if (profileEvents)
+        Config::SetDefault ("ns3::LpFilterScheduler::SchedulerType", StringValue ("ns3::EventProfilingScheduler"));
+      GlobalValue::Bind ("SchedulerType", StringValue ("ns3::LpFilterScheduler"));
+    }
+
+  Config::SetDefault ("ns3::ApWifiMac::CacheBeacon", BooleanValue (cacheBeacon));
+  Config::SetDefault ("ns3::YansWifiPhy::BeaconAirtimeOnly", BooleanValue (beaconAirtimeOnly));
+
   if (!enableRts)
     {
       Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("999999"));
@@ -1272,6 +2570,10 @@ int main (int argc, char *argv[])
   config.channelWidth = channelWidth;
   config.channelNumber = channelNumber;
   config.channelAllocation = channelAllocation;
+  config.partitions = partitions;
+  config.nodeStreams = nodeStreams;
+  config.runLp = -1;
+  config.lpFd = -1;
   config.freq = freq;
 
   config.randomWalk = randomWalk;
@@ -1288,8 +2590,37 @@ int main (int argc, char *argv[])
   config.dynStick = dynStick;
   config.srResetMode = srResetMode;
   config.srConservative = srConservative;
+  config.srWindow = srWindow;
+  config.ecaController = ecaController;
+  config.targetEmptySlots = targetEmptySlots;
+  config.targetCollisions = targetCollisions;
+  NS_ABORT_MSG_IF (controllerWindow == 0, "controllerWindow must be positive");
+  config.controllerWindow = controllerWindow;
+  config.controllerMaxStickiness = maxStickiness < 0 ? stickiness + 1 : maxStickiness;
+  config.rtsSuppression = rtsSuppression;
 
   config.saturation = saturation;
+  config.downlink = downlink;
+
+  config.slotStats = slotStats;
+  config.slotHistogramBins = slotHistogramBins;
+  config.preassociate = preassociate;
+  config.startTime = preassociate ? 0.0 : 1.0;
+
+  config.convergence = convergence;
+  config.convergenceWindow = convergenceWindow;
+  config.convergenceCi = convergenceCi;
+  config.convergenceMinWindows = convergenceMinWindows;
+
+  /* Skipped cycles are only representative if nothing changes later on */
+  if (cycleSkip && (!eca || !saturation || randomWalk || convergence))
+    {
+      std::cout << "cycleSkip needs eca, saturation, static stations and no convergence monitor: "
+        << "simulating the whole run" << std::endl;
+      cycleSkip = false;
+    }
+  config.cycleSkip = cycleSkip;
+  config.cycleSkipCycles = std::max<uint32_t> (cycleSkipCycles, 1);
 
   std::vector<uint64_t> zeroth;
   std::vector<Time> zerothTime;
@@ -1312,6 +2643,11 @@ int main (int argc, char *argv[])
 
   results.nWifis = nWifis;
   results.nStas = nStas;
+  results.elapsedTime = simulationTime;
+  results.stopReason = STOP_MAXTIME;
+  results.creditedPackets.assign (nWifis, std::vector<uint64_t> (nStas, 0));
+  results.skippedCycles = 0;
+  results.skippedTime = 0.0;
 
   InternetStackHelper stack;
   CsmaHelper csma;
@@ -1364,7 +2700,17 @@ int main (int argc, char *argv[])
         
       }
 
-  wifiPhy.SetChannel (wifiChannel.Create ());
+  /* Logical processes share no channel, and every Send only goes through
+   * the PHYs of its own process */
+  assignLogicalProcesses (config);
+  std::vector<Ptr<YansWifiChannel> > lpChannels;
+  if (partitions)
+    {
+      for (uint32_t lp = 0; lp < config.nLps; lp++)
+        lpChannels.push_back (wifiChannel.Create ());
+    }
+  else
+    wifiPhy.SetChannel (wifiChannel.Create ());
 
   for (uint32_t i = 0; i < nWifis; ++i)
     {
@@ -1372,6 +2718,8 @@ int main (int argc, char *argv[])
       std::ostringstream oss;
       oss << "wifi-default-" << i;
       Ssid ssid = Ssid (oss.str ());
+      if (partitions)
+        wifiPhy.SetChannel (lpChannels.at (config.wlanLp.at (i)));
 
       NodeContainer sta;
       NetDeviceContainer staDev;
@@ -1465,13 +2813,27 @@ int main (int argc, char *argv[])
       for (uint32_t j = 0; j < sta.GetN (); j++)
         {
           uint16_t port =  ((i * destPort) + j) + 1;
+          Ptr<Node> serverNode = backboneNodes.Get (i);
+          Ptr<Node> clientNode = sta.Get (j);
+          Ipv4Address serverAddress = ApDestAddress.GetAddress (0);
+          if (downlink)
+            {
+              serverNode = sta.Get (j);
+              clientNode = backboneNodes.Get (i);
+              serverAddress = staInterface.GetAddress (j);
+              /* The backbone node has several interfaces in the same network */
+              Ptr<Ipv4> ipv4 = clientNode->GetObject<Ipv4> ();
+              Ipv4StaticRoutingHelper routing;
+              routing.GetStaticRouting (ipv4)->AddHostRouteTo (serverAddress, ipv4->GetInterfaceForDevice (apDev.Get (0)));
+            }
+
           UdpServerHelper myServer (port);
-          ApplicationContainer serverApp = myServer.Install (backboneNodes.Get (i));
+          ApplicationContainer serverApp = myServer.Install (serverNode);
           serverApp.Start (Seconds (0.0));
-          serverApp.Stop (Seconds (simulationTime + 1));
+          serverApp.Stop (Seconds (config.startTime + simulationTime));
           servers.Add (serverApp);
 
-          UdpClientHelper myClient (ApDestAddress.GetAddress (0), port);
+          UdpClientHelper myClient (serverAddress, port);
           myClient.SetAttribute ("MaxPackets", UintegerValue (4294967295u));
 
           if (!saturation)
@@ -1482,9 +2844,9 @@ int main (int argc, char *argv[])
           myClient.SetAttribute ("Interval", TimeValue (dataGenerationRate)); //packets/s
           myClient.SetAttribute ("PacketSize", UintegerValue (payloadSize));
 
-          ApplicationContainer clientApp = myClient.Install (sta.Get (j));
-          clientApp.Start (Seconds (1.0));
-          clientApp.Stop (Seconds (simulationTime + 1));
+          ApplicationContainer clientApp = myClient.Install (clientNode);
+          clientApp.Start (Seconds (config.startTime));
+          clientApp.Stop (Seconds (config.startTime + simulationTime));
 
           // std::cout << "-Setting UDP flow " << j << "/" << sta.GetN () - 1 << " from ip: " << staInterface.GetAddress (j)
           //   << ", to: " << ApDestAddress.GetAddress (0) << std::endl;
@@ -1515,6 +2877,16 @@ int main (int argc, char *argv[])
       { 
         mobilityUsingBuildings (config, allMobility, backboneNodes, staNodes, staDevices, apDevices);
       }
+  if (partitions)
+    reportLogicalProcesses (config, allNodes);
+  if (nodeStreams)
+    assignNodeStreams (config, staDevices, apDevices);
+  config.nodeLp.assign (NodeList::GetNNodes (), -1);
+  for (uint32_t i = 0; i < nWifis; i++)
+    {
+      for (uint32_t n = 0; n < allNodes.at (i).GetN (); n++)
+        config.nodeLp.at (allNodes.at (i).Get (n)->GetId ()) = config.wlanLp.at (i);
+    }
 
 
 
@@ -1562,14 +2934,141 @@ int main (int argc, char *argv[])
         }
     }
 
-  Simulator::Stop (Seconds (simulationTime + 1));
-  Simulator::Schedule (Seconds (0.5), channelSetup, config, staDevices, apDevices);
-  Simulator::Schedule (Seconds (0.5), finishSetup, config, staNodes);
-  Simulator::Schedule (Seconds (simulationTime + 0.999999), finalResults, config, results_stream, &results, sta_stream, staNodes);
+  if (downlinkQuantum > 0)
+    {
+      for (uint32_t i = 0; i < nWifis; i++)
+        {
+          Ptr<EdcaTxopN> edca = allNodes.at (i).Get (0)->GetDevice (2)->GetObject<WifiNetDevice> ()->GetMac ()
+                                ->GetObject<RegularWifiMac> ()->GetBEQueue ();
+          edca->SetDownlinkFairShare (MicroSeconds (downlinkQuantum));
+        }
+    }
+
+  Simulator::Stop (Seconds (config.startTime + simulationTime));
+  if (preassociate)
+    {
+      /* PHYs are not initialized yet, so this is not a channel switch */
+      channelSetup (config, staDevices, apDevices);
+      preassociateWlans (config, staDevices, apDevices);
+      finishSetup (config, staNodes);
+      if (!loadState.empty ())
+        loadEcaState (config, loadState, staNodes);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (0.5), channelSetup, config, staDevices, apDevices);
+      Simulator::Schedule (Seconds (0.5), finishSetup, config, staNodes);
+      /* Scheduled before Run, so it precedes the applications starting at the same time */
+      if (!loadState.empty ())
+        Simulator::Schedule (Seconds (config.startTime), loadEcaState, config, loadState, staNodes);
+    }
+  if (!saveState.empty ())
+    {
+      NS_ASSERT (warmup < simulationTime);
+      Simulator::Schedule (Seconds (config.startTime + warmup), saveEcaState, config, saveState, staNodes);
+    }
+  if (slotStats)
+    Simulator::Schedule (Seconds (config.startTime), startSlotStats, config, staNodes);
+  EventId finalEvent = Simulator::Schedule (Seconds (config.startTime + simulationTime - 0.000001), finalResults, config, results_stream, &results, sta_stream, staNodes);
+
+  if (convergence)
+    {
+      NS_ASSERT (convergenceWindow > 0);
+      monitor.lastReceived.assign (nWifis, std::vector<uint64_t> (nStas, 0));
+      monitor.lastSx = 0;
+      monitor.lastFailed = 0;
+      struct running_stat empty = {0, 0.0, 0.0};
+      monitor.throughput = monitor.failFrac = monitor.jfi = empty;
+      monitor.finalEvent = finalEvent;
+      monitor.staStream = sta_stream;
+      monitor.sta = staNodes;
+      Simulator::Schedule (Seconds (config.startTime + convergenceWindow), checkConvergence, config, &results, &monitor);
+    }
+
+  if (config.cycleSkip)
+    {
+      skip.active = false;
+      skip.stableCycles = 0;
+      skip.done = false;
+      skip.current.assign (nWifis, std::vector<uint32_t> (nStas + 1, 0));
+      skip.cycleReceived.assign (nWifis, std::vector<uint64_t> (nStas, 0));
+      skip.finalEvent = finalEvent;
+      skip.staStream = sta_stream;
+      skip.sta = staNodes;
+    }
 
   
 
 
-  Simulator::Run ();
+  SystemWallClockMs runClock;
+  runClock.Start ();
+  std::vector<struct lp_process> lpChildren;
+  int32_t lp = -1;
+  uint64_t lpEvents = 0;
+  if (parallel)
+    lp = forkLogicalProcesses (config, lpChildren);
+  if (!parallel)
+    Simulator::Run ();
+  else if (lp >= 0)
+    {
+      redirectLpLog (tx_stream, txLog, lp);
+      redirectLpLog (backoff_stream, backoffLog, lp);
+      redirectLpLog (sr_stream, srLog, lp);
+      redirectLpLog (bitmap_stream, bitmapLog, lp);
+      redirectLpLog (fs_stream, fsLog, lp);
+      Simulator::Cancel (finalEvent);
+      Simulator::Schedule (Seconds (config.startTime + simulationTime - 0.000001), sendLpResults, config, &results);
+      Simulator::Run ();
+      Simulator::Destroy ();
+      tx_stream->GetStream ()->flush ();
+      backoff_stream->GetStream ()->flush ();
+      sr_stream->GetStream ()->flush ();
+      bitmap_stream->GetStream ()->flush ();
+      fs_stream->GetStream ()->flush ();
+      std::cout.flush ();
+      _exit (0);
+    }
+  else
+    {
+      Simulator::Cancel (finalEvent);
+      lpEvents = mergeLpResults (config, &results, lpChildren);
+      finalResults (config, results_stream, &results, sta_stream, staNodes);
+    }
+  double runSeconds = runClock.End () / 1000.0;
+  double wallSeconds = wallClock.End () / 1000.0;
+
+  if (!benchmark.empty ())
+    {
+      uint64_t delivered = 0;
+      for (uint32_t i = 0; i < config.servers.size (); i++)
+        for (uint32_t j = 0; j < config.servers.at (i).GetN (); j++)
+          delivered += DynamicCast<UdpServer> (config.servers.at (i).Get (j))->GetReceived ()
+            + results.creditedPackets.at (i).at (j);
+      struct rusage usage;
+      getrusage (RUSAGE_SELF, &usage);
+      double simulated = Simulator::Now ().GetSeconds ();
+      uint64_t events = Simulator::GetEventCount ();
+      if (parallel)
+        {
+          /* The largest LP */
+          struct rusage children;
+          getrusage (RUSAGE_CHILDREN, &children);
+          usage.ru_maxrss = std::max (usage.ru_maxrss, children.ru_maxrss);
+          simulated = config.startTime + simulationTime;
+          events = lpEvents;
+        }
+
+      /* 1-8: benchmark point, 9. seed, 10. simulated seconds, 11. wall seconds (setup and run),
+         12. wall seconds of the run, 13. simulated seconds per wall second of the run,
+         14. events, 15. events per wall second of the run, 16. peak RSS (KB), 17. delivered frames */
+      std::ofstream out (benchmark.c_str (), std::ios::app);
+      out << nWifis << " " << nStas << " " << eca << " " << hysteresis << " " << bitmap << " " << fairShare
+        << " " << fairShareAMPDU << " " << defaultPositions << " " << seed
+        << " " << simulated << " " << wallSeconds << " " << runSeconds
+        << " " << (runSeconds > 0 ? simulated / runSeconds : 0)
+        << " " << events << " " << (runSeconds > 0 ? events / runSeconds : 0)
+        << " " << usage.ru_maxrss << " " << delivered << std::endl;
+    }
+
   Simulator::Destroy ();
 }
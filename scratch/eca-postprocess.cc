@@ -0,0 +1,376 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Luis Sanabria-Russo <luis.sanabria@upf.edu>
+ */
+
+// Post-processing of the results and tx.log files written by wlan.cc.
+// It writes the same files as tmp/process and tmp/staProcess, reading
+// every file once:
+//
+// - averaged.dat: for every number of nodes in the results file, mean
+//   and standard deviation of each of the other columns.
+// - totalAveraged.dat: the same over all the rows of the results file.
+// - staAveraged-<last station>.dat: for every tx.log, the last value
+//   logged by each station for each log code.
+// - The number of instants whose last tx.log record is a failure
+//   (collisions seen by an outside observer) is printed.
+//
+// Files are mapped in memory and each one is processed by its own thread.
+//
+// ./waf --run "eca-postprocess --results=results.log --txLogs=tx.log,../other/tx.log"
+
+#include "ns3/core-module.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+#include <map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+//Defining log codes for interesting metrics (as in wlan.cc)
+#define FAILTX 2 //failures
+
+using namespace ns3;
+
+/* Welford's running mean and variance */
+struct running_stat
+{
+  uint64_t n;
+  double mean;
+  double m2;
+};
+
+void
+AddSample (struct running_stat &stat, double x)
+{
+  stat.n++;
+  double delta = x - stat.mean;
+  stat.mean += delta / stat.n;
+  stat.m2 += delta * (x - stat.mean);
+}
+
+/* Population standard deviation, as Statistics::Basic computes it */
+double
+GetStdDev (const struct running_stat &stat)
+{
+  if (stat.n == 0)
+    return 0.0;
+  return std::sqrt (stat.m2 / stat.n);
+}
+
+/* Same formatting as a Perl number */
+std::string
+FormatNumber (double x)
+{
+  char buffer[32];
+  std::snprintf (buffer, sizeof (buffer), "%.15g", x);
+  return buffer;
+}
+
+/* A whole file mapped read-only */
+struct mapped_file
+{
+  const char *data;
+  size_t size;
+};
+
+bool
+MapFile (const std::string &name, struct mapped_file &file)
+{
+  file.data = 0;
+  file.size = 0;
+  int fd = open (name.c_str (), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat (fd, &st) < 0)
+    {
+      close (fd);
+      return false;
+    }
+  file.size = st.st_size;
+  if (file.size > 0)
+    {
+      void *data = mmap (0, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+        {
+          close (fd);
+          return false;
+        }
+      madvise (data, file.size, MADV_SEQUENTIAL);
+      file.data = static_cast<const char *> (data);
+    }
+  close (fd);
+  return true;
+}
+
+void
+UnmapFile (struct mapped_file &file)
+{
+  if (file.size > 0)
+    munmap (const_cast<char *> (file.data), file.size);
+  file.data = 0;
+  file.size = 0;
+}
+
+/* A field of a line, pointing into the mapped file */
+struct field
+{
+  const char *begin;
+  const char *end;
+};
+
+/* Splits the line starting at pos in whitespace separated fields, and
+ * moves pos to the next line. Returns false at the end of the file. */
+bool
+NextLine (const char *&pos, const char *end, std::vector<struct field> &fields)
+{
+  fields.clear ();
+  if (pos >= end)
+    return false;
+  while (pos < end && *pos != '\n')
+    {
+      while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+        pos++;
+      if (pos == end || *pos == '\n')
+        break;
+      struct field f;
+      f.begin = pos;
+      while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n')
+        pos++;
+      f.end = pos;
+      fields.push_back (f);
+    }
+  if (pos < end)
+    pos++; // the newline
+  return true;
+}
+
+/* The field is not null-terminated, so it is copied before parsing */
+double
+ToDouble (const struct field &f)
+{
+  char buffer[64];
+  size_t length = std::min<size_t> (f.end - f.begin, sizeof (buffer) - 1);
+  std::copy (f.begin, f.begin + length, buffer);
+  buffer[length] = '\0';
+  return std::strtod (buffer, 0);
+}
+
+int64_t
+ToInt (const struct field &f)
+{
+  return (int64_t) ToDouble (f);
+}
+
+std::string
+ToString (const struct field &f)
+{
+  return std::string (f.begin, f.end);
+}
+
+/* Results file: one row per run, the first column is the number of nodes */
+void
+processResults (std::string inputFile, std::string *report)
+{
+  struct mapped_file file;
+  if (!MapFile (inputFile, file))
+    {
+      *report = "Could not open file '" + inputFile + "'\n";
+      return;
+    }
+
+  struct running_stat empty = {0, 0.0, 0.0};
+  std::map<int64_t, std::vector<struct running_stat> > perNodes;
+  std::vector<struct running_stat> total;
+  std::vector<struct field> fields;
+  const char *pos = file.data;
+  const char *end = file.data + file.size;
+  uint64_t rows = 0;
+  while (NextLine (pos, end, fields))
+    {
+      if (fields.empty ())
+        continue;
+      rows++;
+      std::vector<struct running_stat> &stats = perNodes[ToInt (fields.at (0))];
+      if (stats.size () < fields.size () - 1)
+        stats.resize (fields.size () - 1, empty);
+      if (total.size () < fields.size () - 1)
+        total.resize (fields.size () - 1, empty);
+      for (uint32_t i = 1; i < fields.size (); i++)
+        {
+          double x = ToDouble (fields.at (i));
+          AddSample (stats.at (i - 1), x);
+          AddSample (total.at (i - 1), x);
+        }
+    }
+  UnmapFile (file);
+
+  //Odd indexes are standard deviations in the resulting files
+  std::ofstream averaged ("averaged.dat");
+  averaged << "#1 Nodes #2 AvgThroughput\n";
+  for (std::map<int64_t, std::vector<struct running_stat> >::const_iterator it = perNodes.begin ();
+       it != perNodes.end (); it++)
+    {
+      averaged << it->first << " ";
+      for (uint32_t i = 0; i < it->second.size (); i++)
+        averaged << FormatNumber (it->second.at (i).mean) << " " << FormatNumber (GetStdDev (it->second.at (i))) << " ";
+      averaged << "\n";
+    }
+
+  std::ofstream totalAveraged ("totalAveraged.dat");
+  totalAveraged << "#1 Rows #2 AvgThroughput\n";
+  totalAveraged << rows << " ";
+  for (uint32_t i = 0; i < total.size (); i++)
+    totalAveraged << FormatNumber (total.at (i).mean) << " " << FormatNumber (GetStdDev (total.at (i))) << " ";
+  totalAveraged << "\n";
+}
+
+/* tx.log of wlan.cc: time, station, log code, value */
+void
+processTxLog (std::string inputFile, bool plot, double load, std::string *report)
+{
+  struct mapped_file file;
+  if (!MapFile (inputFile, file))
+    {
+      *report = "Could not open file '" + inputFile + "'\n";
+      return;
+    }
+
+  std::map<int64_t, std::map<int64_t, std::string> > lastValue; // station -> code -> value
+  uint64_t collisions = 0;
+  bool started = false;
+  int64_t now = 0;
+  bool lastIsFailure = false;
+  std::vector<struct field> fields;
+  const char *pos = file.data;
+  const char *end = file.data + file.size;
+  while (NextLine (pos, end, fields))
+    {
+      if (fields.size () < 4)
+        continue;
+      int64_t time = ToInt (fields.at (0));
+      /* Only the last record of every instant counts */
+      if (started && time != now && lastIsFailure)
+        collisions++;
+      started = true;
+      now = time;
+      int64_t code = ToInt (fields.at (2));
+      lastIsFailure = (code == FAILTX);
+      lastValue[ToInt (fields.at (1))][code] = ToString (fields.at (3));
+    }
+  if (started && lastIsFailure)
+    collisions++;
+  UnmapFile (file);
+
+  std::ostringstream out;
+  out << "-Collisions seen as an outside observer: " << collisions << "\n\n";
+  if (lastValue.empty ())
+    {
+      *report = out.str ();
+      return;
+    }
+
+  /* Written next to the tx.log */
+  std::string directory = "";
+  size_t slash = inputFile.rfind ('/');
+  if (slash != std::string::npos)
+    directory = inputFile.substr (0, slash + 1);
+  std::ostringstream outputFile;
+  outputFile << directory << "staAveraged-" << lastValue.rbegin ()->first << ".dat";
+
+  std::ofstream staAveraged (outputFile.str ().c_str ());
+  staAveraged << "#1 Station #2 AvgSxTx #3 AvgFailed #4 AvgTxAttmpt #5\n";
+  for (std::map<int64_t, std::map<int64_t, std::string> >::const_iterator it = lastValue.begin ();
+       it != lastValue.end (); it++)
+    {
+      staAveraged << it->first << " ";
+      int64_t lastCode = it->second.rbegin ()->first;
+      for (int64_t code = 1; code <= lastCode; code++)
+        {
+          std::map<int64_t, std::string>::const_iterator value = it->second.find (code);
+          if (value == it->second.end ())
+            staAveraged << "0 ";
+          else
+            staAveraged << value->second << " ";
+        }
+      staAveraged << "\n";
+    }
+  staAveraged.close ();
+
+  if (plot)
+    {
+      std::ostringstream command;
+      command << "gnuplot -c ./staPlot " << outputFile.str () << " " << load;
+      if (std::system (command.str ().c_str ()) != 0)
+        out << "Could not run: " << command.str () << "\n";
+    }
+  *report = out.str ();
+}
+
+int main (int argc, char *argv[])
+{
+  std::string results ("");
+  std::string txLogs ("tx.log");
+  bool plot = false;
+  double simTime = 50; //Should match the simulation
+  uint32_t payloadSize = 1470; //This should match the packet length in wlan.cc
+
+  CommandLine cmd;
+  cmd.AddValue ("results", "Results file to average per number of nodes (empty: none)", results);
+  cmd.AddValue ("txLogs", "Comma separated tx.log files to reduce per station (empty: none)", txLogs);
+  cmd.AddValue ("plot", "Plot every staAveraged file with staPlot", plot);
+  cmd.AddValue ("simTime", "Simulation time of the runs, for the plots", simTime);
+  cmd.AddValue ("payloadSize", "Payload of the runs in bytes, for the plots", payloadSize);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> files;
+  std::stringstream ss (txLogs);
+  std::string name;
+  while (std::getline (ss, name, ','))
+    {
+      if (!name.empty ())
+        files.push_back (name);
+    }
+
+  double load = payloadSize * 8 * 1.0 / simTime;
+  std::vector<std::string> reports (files.size () + 1);
+  std::vector<std::thread> threads;
+  if (!results.empty ())
+    threads.push_back (std::thread (processResults, results, &reports.at (0)));
+  for (uint32_t i = 0; i < files.size (); i++)
+    threads.push_back (std::thread (processTxLog, files.at (i), plot, load, &reports.at (i + 1)));
+  for (uint32_t i = 0; i < threads.size (); i++)
+    threads.at (i).join ();
+
+  std::cout << reports.at (0);
+  for (uint32_t i = 0; i < files.size (); i++)
+    {
+      if (files.size () > 1)
+        std::cout << files.at (i) << ":" << std::endl;
+      std::cout << reports.at (i + 1);
+    }
+  return 0;
+}
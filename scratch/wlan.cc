@@ -17,6 +17,9 @@
  */
 #include <iomanip>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/applications-module.h"
@@ -79,9 +82,123 @@ struct sim_results{
   std::vector<Time> sumTimeBetweenSxTx;
   std::vector<Time> timeOfPrevSxTx;
   uint64_t errorFrames;
+  double finalRow[3]; // what printResults writes after the number of nodes
 };
 struct sim_results results;
 
+/* Welford's running mean and variance */
+struct running_stat
+{
+  uint64_t n;
+  double mean;
+  double m2;
+};
+
+void
+AddSample (struct running_stat &stat, double x)
+{
+  stat.n++;
+  double delta = x - stat.mean;
+  stat.mean += delta / stat.n;
+  stat.m2 += delta * (x - stat.mean);
+}
+
+/* Statistics of all the runs with the same number of nodes, kept in a
+ * binary state file across the runs of a sweep. Fields are written one
+ * by one, so the file does not depend on the padding of the struct */
+#define RESULTS_STATE_MAGIC 0x45434132 //"ECA2"
+struct results_point
+{
+  uint32_t nodes;
+  struct running_stat stats[3];
+};
+
+bool
+ComparePoints (const struct results_point &a, const struct results_point &b)
+{
+  return a.nodes < b.nodes;
+}
+
+template <typename T>
+bool
+readField (std::istream &in, T &value)
+{
+  return (bool) in.read (reinterpret_cast<char *> (&value), sizeof (value));
+}
+
+template <typename T>
+void
+writeField (std::ostream &out, const T &value)
+{
+  out.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+std::vector<struct results_point>
+loadResultsState (const std::string &fileName)
+{
+  std::vector<struct results_point> points;
+  std::ifstream state (fileName.c_str (), std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t n = 0;
+  if (!readField (state, magic) || magic != RESULTS_STATE_MAGIC || !readField (state, n))
+    return points;
+  points.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      bool ok = readField (state, points.at (i).nodes);
+      for (uint32_t j = 0; ok && j < 3; j++)
+        {
+          struct running_stat &stat = points.at (i).stats[j];
+          ok = readField (state, stat.n) && readField (state, stat.mean) && readField (state, stat.m2);
+        }
+      if (!ok)
+        {
+          points.clear ();
+          break;
+        }
+    }
+  return points;
+}
+
+void
+saveResultsState (const std::string &fileName, const std::vector<struct results_point> &points)
+{
+  std::ofstream state (fileName.c_str (), std::ios::binary | std::ios::trunc);
+  writeField<uint32_t> (state, RESULTS_STATE_MAGIC);
+  writeField<uint32_t> (state, points.size ());
+  for (uint32_t i = 0; i < points.size (); i++)
+    {
+      writeField (state, points.at (i).nodes);
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          const struct running_stat &stat = points.at (i).stats[j];
+          writeField (state, stat.n);
+          writeField (state, stat.mean);
+          writeField (state, stat.m2);
+        }
+    }
+}
+
+/* Same layout as tmp/process: means and (population) standard deviations */
+void
+writeAveraged (const std::string &fileName, const std::vector<struct results_point> &points)
+{
+  std::ofstream averaged (fileName.c_str ());
+  averaged << std::setprecision (15);
+  //Odd indexes are standard deviations in the resulting file
+  averaged << "#1 Nodes #2 AvgThroughput\n";
+  for (uint32_t i = 0; i < points.size (); i++)
+    {
+      averaged << points.at (i).nodes << " ";
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          const struct running_stat &stat = points.at (i).stats[j];
+          averaged << stat.mean << " " << std::sqrt (stat.m2 / stat.n) << " ";
+        }
+      averaged << "\n";
+    }
+}
+
 
 void
 printResults(struct sim_config &config, Ptr<OutputStreamWrapper> stream, double &startClientApp, struct sim_results *results)
@@ -156,15 +273,45 @@ printResults(struct sim_config &config, Ptr<OutputStreamWrapper> stream, double
   *stream->GetStream() << config.nWifi << " " << std::fixed << std::setprecision(6)
     << rx_bits / simulationDuration.GetSeconds() << " " << col/attempts << " " << overallTimeBetweenSxTx/config.servers.GetN()
     << std::endl;
+
+  results->finalRow[0] = rx_bits / simulationDuration.GetSeconds();
+  results->finalRow[1] = col/attempts;
+  results->finalRow[2] = overallTimeBetweenSxTx/config.servers.GetN();
 }
 
+/* Folds the results of this run into the statistics of the sweep and
+ * regenerates averaged.dat from them */
 void
-processFinal(std::string &dataFileName)
+processFinal(struct sim_config &config, struct sim_results *results, std::string &stateFileName,
+  std::string &averagedFileName)
 {
-  std::string prefix("(cd ~/Dropbox/PhD/Research/NS3/ns-allinone-3.24.1/bake/source/ns-3.24/tmp && ./process ");
-  std::string command = prefix + dataFileName + ")";
-  // std::cout << "Processing the output file: " << command << std::endl;
-  system(command.c_str());
+  std::vector<struct results_point> points = loadResultsState (stateFileName);
+  uint32_t i = 0;
+  while (i < points.size () && points.at (i).nodes != config.nWifi)
+    i++;
+  if (i == points.size ())
+    {
+      struct results_point point;
+      point.nodes = config.nWifi;
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          point.stats[j].n = 0;
+          point.stats[j].mean = 0.0;
+          point.stats[j].m2 = 0.0;
+        }
+      points.push_back (point);
+      std::sort (points.begin (), points.end (), ComparePoints);
+    }
+  for (i = 0; i < points.size (); i++)
+    {
+      if (points.at (i).nodes != config.nWifi)
+        continue;
+      for (uint32_t j = 0; j < 3; j++)
+        AddSample (points.at (i).stats[j], results->finalRow[j]);
+    }
+  saveResultsState (stateFileName, points);
+  if (!averagedFileName.empty ())
+    writeAveraged (averagedFileName, points);
 }
 
 //Trace callbacks
@@ -386,6 +533,8 @@ main (int argc, char *argv[])
   double txRate = 54; //in Mbps
   std::string logName ("debug.log");
   std::string resultsName ("results.log");
+  std::string resultsState ("results.state");
+  std::string averagedName ("averaged.dat");
   std::string txLog ("tx.log");
   std::string backoffLog ("detBackoff.log");
   std::string bitmapLog ("bitmap.log");
@@ -406,6 +555,7 @@ main (int argc, char *argv[])
   uint32_t EIFSnoDIFS = 314; //µs
   uint32_t ackTimeout = 340; //µs
   double frameMinFer = 0.0;
+  bool averagedOnly = false;
 
 
   CommandLine cmd;
@@ -429,9 +579,19 @@ main (int argc, char *argv[])
   cmd.AddValue ("EIFSnoDIFS", "IFS before retransmitting a frame", EIFSnoDIFS);
   cmd.AddValue ("AckTimeout", "Time that will timeout the DATA+ACK exchange", ackTimeout);
   cmd.AddValue ("frameMinFer", "Frame error rate at PHY level", frameMinFer);
+  cmd.AddValue ("resultsState", "Binary file with the statistics of all the runs of a sweep", resultsState);
+  cmd.AddValue ("averagedName", "Where to write the averaged statistics after the run (empty: nowhere)", averagedName);
+  cmd.AddValue ("averagedOnly", "Only regenerate averagedName from resultsState, without simulating", averagedOnly);
 
   cmd.Parse (argc,argv);
 
+  if (averagedOnly)
+    {
+      NS_ABORT_MSG_IF (averagedName.empty (), "--averagedOnly needs --averagedName");
+      writeAveraged (averagedName, loadResultsState (resultsState));
+      return 0;
+    }
+
   config.nWifi = nWifi;
   config.lastReport = ns3::Time (MicroSeconds (0));
   config.tracing = tracing;
@@ -666,7 +826,8 @@ main (int argc, char *argv[])
   //Last call to the printResults function
   Simulator::Schedule (Seconds(startClientApp  + totalSimtime - 0.000009), printResults, 
     config, results_stream, startClientApp, &results);
-  Simulator::Schedule (Seconds(startClientApp  + totalSimtime - 0.000009), processFinal, resultsName);
+  Simulator::Schedule (Seconds(startClientApp  + totalSimtime - 0.000009), processFinal,
+    config, &results, resultsState, averagedName);
   Simulator::Run ();
   Simulator::Destroy ();
   return 0;
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/abort.h"
 
 #include "ipv4-l3-protocol.h"
 #include "arp-l3-protocol.h"
@@ -126,6 +127,7 @@ ArpL3Protocol::DoDispose (void)
       cache->Dispose ();
     }
   m_cacheList.clear ();
+  m_cacheByIfIndex.clear ();
   m_node = 0;
   Object::DoDispose ();
 }
@@ -141,6 +143,12 @@ ArpL3Protocol::CreateCache (Ptr<NetDevice> device, Ptr<Ipv4Interface> interface)
   device->AddLinkChangeCallback (MakeCallback (&ArpCache::Flush, cache));
   cache->SetArpRequestCallback (MakeCallback (&ArpL3Protocol::SendArpRequest, this));
   m_cacheList.push_back (cache);
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex >= m_cacheByIfIndex.size ())
+    {
+      m_cacheByIfIndex.resize (ifIndex + 1);
+    }
+  m_cacheByIfIndex[ifIndex] = cache;
   return cache;
 }
 
@@ -148,6 +156,14 @@ Ptr<ArpCache>
 ArpL3Protocol::FindCache (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex < m_cacheByIfIndex.size ()
+      && m_cacheByIfIndex[ifIndex] != 0
+      && m_cacheByIfIndex[ifIndex]->GetDevice () == device)
+    {
+      return m_cacheByIfIndex[ifIndex];
+    }
+  //Not indexed (e.g., device of another node): fall back to the list
   for (CacheList::const_iterator i = m_cacheList.begin (); i != m_cacheList.end (); i++)
     {
       if ((*i)->GetDevice () == device)
@@ -160,6 +176,45 @@ ArpL3Protocol::FindCache (Ptr<NetDevice> device)
   return 0;
 }
 
+uint32_t
+ArpL3Protocol::ProvisionCache (Ptr<NetDevice> device, const ArpTable &table)
+{
+  NS_LOG_FUNCTION (this << device << table.size ());
+  Ptr<ArpCache> cache = FindCache (device);
+  NS_ABORT_MSG_IF (cache == 0, "No ARP cache for device " << device << ": is the Ipv4 stack installed on it?");
+  Address self = device->GetAddress ();
+  uint32_t installed = 0;
+
+  for (ArpTable::const_iterator i = table.begin (); i != table.end (); ++i)
+    {
+      if (i->second == self)
+        {
+          continue;
+        }
+      ArpCache::Entry *entry = cache->Lookup (i->first);
+      if (entry == 0)
+        {
+          entry = cache->Add (i->first);
+        }
+      if (entry->IsWaitReply ())
+        {
+          //A request is already out: behave as if the reply arrived
+          entry->MarkAlive (i->second);
+          Ptr<Packet> pending = entry->DequeuePending ();
+          while (pending != 0)
+            {
+              cache->GetInterface ()->Send (pending, i->first);
+              pending = entry->DequeuePending ();
+            }
+        }
+      entry->SetMacAddress (i->second);
+      entry->MarkPermanent ();
+      installed++;
+    }
+  NS_LOG_LOGIC ("node=" << m_node->GetId () << " installed " << installed << " ARP entries");
+  return installed;
+}
+
 void 
 ArpL3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from,
                         const Address &to, NetDevice::PacketType packetType)
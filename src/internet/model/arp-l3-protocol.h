@@ -21,12 +21,15 @@
 #define ARP_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
+#include <utility>
 #include "ns3/ipv4-address.h"
 #include "ns3/net-device.h"
 #include "ns3/address.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -56,6 +59,9 @@ public:
   static TypeId GetTypeId (void);
   static const uint16_t PROT_NUMBER; //!< ARP protocol number (0x0806)
 
+  /// Resolved (IP address, hardware address) pairs, e.g., of a whole subnet
+  typedef std::vector<std::pair<Ipv4Address, Address> > ArpTable;
+
   ArpL3Protocol ();
   virtual ~ArpL3Protocol ();
 
@@ -115,6 +121,22 @@ public:
    */
   Ptr<ArpCache> FindCache (Ptr<NetDevice> device);
 
+  /**
+   * \brief Install a table of resolved entries in the cache of a device
+   *
+   * Every entry is created (or replaced) as PERMANENT, so no request is
+   * ever sent for these addresses. Packets already waiting for a reply
+   * are sent. The alive timeout of the cache is left alone, so entries
+   * learned later expire as usual. Entries whose hardware address is the
+   * one of \p device itself are skipped, so the same table can be given
+   * to every member of a subnet.
+   *
+   * \param device the NetDevice whose cache is provisioned
+   * \param table the (IP, MAC) pairs to install
+   * \returns the number of entries installed
+   */
+  uint32_t ProvisionCache (Ptr<NetDevice> device, const ArpTable &table);
+
 protected:
   virtual void DoDispose (void);
   /*
@@ -163,6 +185,7 @@ private:
   void SendArpReply (Ptr<const ArpCache> cache, Ipv4Address myIp, Ipv4Address toIp, Address toMac);
 
   CacheList m_cacheList; //!< ARP cache container
+  std::vector<Ptr<ArpCache> > m_cacheByIfIndex; //!< ARP caches indexed by device IfIndex
   Ptr<Node> m_node; //!< node the ARP L3 protocol is associated with
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by ARP
   Ptr<RandomVariableStream> m_requestJitter; //!< jitter to de-sync ARP requests
@@ -69,6 +69,13 @@ ApWifiMac::GetTypeId (void)
                    MakeBooleanAccessor (&ApWifiMac::SetBeaconGeneration,
                                         &ApWifiMac::GetBeaconGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("CacheBeacon", "If true, the beacon frame is built and serialized only once and a copy "
+                   "of it is queued at every beacon interval. The cache is rebuilt when the SSID, address, "
+                   "beacon interval or channel width change. Note that the beacon timestamp is then frozen "
+                   "at the time the cache was built.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ApWifiMac::m_cacheBeacon),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -88,6 +95,8 @@ ApWifiMac::ApWifiMac ()
   SetTypeOfStation (AP);
 
   m_enableBeaconGeneration = false;
+  m_cacheBeacon = false;
+  m_cachedBeaconWidth = 0;
 }
 
 ApWifiMac::~ApWifiMac ()
@@ -100,6 +109,7 @@ ApWifiMac::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_beaconDca = 0;
+  m_cachedBeacon = 0;
   m_enableBeaconGeneration = false;
   m_beaconEvent.Cancel ();
   RegularWifiMac::DoDispose ();
@@ -113,6 +123,15 @@ ApWifiMac::SetAddress (Mac48Address address)
   //overriding this function and setting both in our parent class.
   RegularWifiMac::SetAddress (address);
   RegularWifiMac::SetBssid (address);
+  InvalidateBeaconCache ();
+}
+
+void
+ApWifiMac::SetSsid (Ssid ssid)
+{
+  NS_LOG_FUNCTION (this << ssid);
+  RegularWifiMac::SetSsid (ssid);
+  InvalidateBeaconCache ();
 }
 
 void
@@ -150,6 +169,7 @@ ApWifiMac::SetWifiRemoteStationManager (Ptr<WifiRemoteStationManager> stationMan
   NS_LOG_FUNCTION (this << stationManager);
   m_beaconDca->SetWifiRemoteStationManager (stationManager);
   RegularWifiMac::SetWifiRemoteStationManager (stationManager);
+  InvalidateBeaconCache ();
 }
 
 void
@@ -173,6 +193,7 @@ ApWifiMac::SetBeaconInterval (Time interval)
       NS_LOG_WARN ("beacon interval should be multiple of 1024us (802.11 time unit), see IEEE Std. 802.11-2012");
     }
   m_beaconInterval = interval;
+  InvalidateBeaconCache ();
 }
 
 void
@@ -478,11 +499,10 @@ ApWifiMac::SendAssocResp (Mac48Address to, bool success)
   m_dca->Queue (packet, hdr);
 }
 
-void
-ApWifiMac::SendOneBeacon (void)
+Ptr<Packet>
+ApWifiMac::BuildBeacon (WifiMacHeader &hdr) const
 {
   NS_LOG_FUNCTION (this);
-  WifiMacHeader hdr;
   hdr.SetBeacon ();
   hdr.SetAddr1 (Mac48Address::GetBroadcast ());
   hdr.SetAddr2 (GetAddress ());
@@ -504,9 +524,41 @@ ApWifiMac::SendOneBeacon (void)
       beacon.SetVhtCapabilities (GetVhtCapabilities ());
     }
   packet->AddHeader (beacon);
+  return packet;
+}
+
+void
+ApWifiMac::InvalidateBeaconCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cachedBeacon = 0;
+}
 
-  //The beacon has it's own special queue, so we load it in there
-  m_beaconDca->Queue (packet, hdr);
+void
+ApWifiMac::SendOneBeacon (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_cacheBeacon)
+    {
+      //The channel width may be changed after beaconing has started
+      //(e.g., when channels are assigned once the topology is built),
+      //and it is advertised in the HT/VHT capabilities.
+      if (m_cachedBeacon == 0 || m_cachedBeaconWidth != m_phy->GetChannelWidth ())
+        {
+          m_cachedBeaconHdr = WifiMacHeader ();
+          m_cachedBeacon = BuildBeacon (m_cachedBeaconHdr);
+          m_cachedBeaconWidth = m_phy->GetChannelWidth ();
+        }
+      //The beacon has it's own special queue, so we load it in there
+      m_beaconDca->Queue (m_cachedBeacon->Copy (), m_cachedBeaconHdr);
+    }
+  else
+    {
+      WifiMacHeader hdr;
+      Ptr<Packet> packet = BuildBeacon (hdr);
+      //The beacon has it's own special queue, so we load it in there
+      m_beaconDca->Queue (packet, hdr);
+    }
   m_beaconEvent = Simulator::Schedule (m_beaconInterval, &ApWifiMac::SendOneBeacon, this);
 }
 
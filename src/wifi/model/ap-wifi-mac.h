@@ -86,6 +86,10 @@ public:
    * \param address the current address of this MAC layer.
    */
   virtual void SetAddress (Mac48Address address);
+  /**
+   * \param ssid the current SSID of this MAC layer.
+   */
+  virtual void SetSsid (Ssid ssid);
   /**
    * \param interval the interval between two beacon transmissions.
    */
@@ -213,6 +217,18 @@ private:
    * \return true if beacons are periodically generated, false otherwise
    */
   bool GetBeaconGeneration (void) const;
+  /**
+   * Build the beacon frame body from the current AP configuration.
+   *
+   * \param hdr the MAC header to be filled for the beacon
+   *
+   * \return the beacon packet (MgtBeaconHeader already added)
+   */
+  Ptr<Packet> BuildBeacon (WifiMacHeader &hdr) const;
+  /**
+   * Drop the cached beacon so that the next beacon interval rebuilds it.
+   */
+  void InvalidateBeaconCache (void);
 
   virtual void DoDispose (void);
   virtual void DoInitialize (void);
@@ -223,6 +239,10 @@ private:
   EventId m_beaconEvent;                     //!< Event to generate one beacon
   Ptr<UniformRandomVariable> m_beaconJitter; //!< UniformRandomVariable used to randomize the time of the first beacon
   bool m_enableBeaconJitter;                 //!< Flag if the first beacon should be generated at random time
+  bool m_cacheBeacon;                        //!< Flag if the serialized beacon is built once and reused
+  Ptr<Packet> m_cachedBeacon;                //!< Cached beacon body (only if m_cacheBeacon)
+  WifiMacHeader m_cachedBeaconHdr;           //!< MAC header matching m_cachedBeacon
+  uint32_t m_cachedBeaconWidth;              //!< Channel width the cached beacon was built for
 };
 
 } //namespace ns3
@@ -36,13 +36,12 @@
 #include "wifi-mac-trailer.h"
 #include "wifi-mac.h"
 #include "random-stream.h"
+#include "eca-policy.h"
+#include "hot-log.h"
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT if (m_low != 0) { std::clog << "[mac=" << m_low->GetAddress () << "] "; }
 
-#define MY_DEBUG(x) \
-  NS_LOG_DEBUG (Simulator::Now () << " " << this << " " << x)
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DcaTxop");
@@ -80,6 +79,10 @@ private:
   {
     m_txop->NotifyWakeUp ();
   }
+  virtual void DoNotifyEcaConfigChanged (void)
+  {
+    m_txop->SelectEcaPolicy ();
+  }
 
   DcaTxop *m_txop;
 };
@@ -176,6 +179,21 @@ DcaTxop::GetTypeId (void)
     .AddTraceSource ("SrReductionFailed", "Times does not comply with SR criteria",
                     MakeTraceSourceAccessor (&DcaTxop::m_scheduleReductionFailed),
                     "ns3::Traced::Value:Uint32Callback")
+    .AddTraceSource ("EcaEmptySlots", "Empty slot fraction seen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&DcaTxop::m_ctrlEmptySlots),
+                    "ns3::Traced::Value::DoubleCallback")
+    .AddTraceSource ("EcaCollisionRate", "Failure rate seen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&DcaTxop::m_ctrlCollisionRate),
+                    "ns3::Traced::Value::DoubleCallback")
+    .AddTraceSource ("EcaStickiness", "Stickiness chosen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&DcaTxop::m_ctrlStickiness),
+                    "ns3::Traced::Value::Uint32Callback")
+    .AddTraceSource ("EcaCwStepDowns", "CW stages dropped by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&DcaTxop::m_ctrlCwStepDowns),
+                    "ns3::Traced::Value::Uint32Callback")
+    .AddTraceSource ("EcaRtsEnabled", "Whether CSMA/ECA lets RTS/CTS protect the next transmission",
+                    MakeTraceSourceAccessor (&DcaTxop::m_ecaRtsEnabled),
+                    "ns3::Traced::Value::BoolCallback")
   ;
   return tid;
 }
@@ -183,12 +201,8 @@ DcaTxop::GetTypeId (void)
 DcaTxop::DcaTxop ()
   : m_manager (0),
     m_currentPacket (0),
-    m_srActivationThreshold (0),
-    m_srBeingFilled (false),
-    m_srIterations (0),
-    m_srReductionFactor (1),
-    m_scheduleRecentlyReduced (false),
-    m_srPreviousCw (0),
+    m_eca (0),
+    m_ecaConfig (EcaPolicy::GetDefaultConfig ()),
     m_failures (0),
     m_successes (0),
     m_txAttempts (0),
@@ -196,7 +210,12 @@ DcaTxop::DcaTxop ()
     m_ecaBitmap (false),
     m_scheduleReductions (0),
     m_scheduleReductionAttempts (0),
-    m_scheduleReductionFailed (0)
+    m_scheduleReductionFailed (0),
+    m_ctrlEmptySlots (0),
+    m_ctrlCollisionRate (0),
+    m_ctrlStickiness (0),
+    m_ctrlCwStepDowns (0),
+    m_ecaRtsEnabled (true)
 {
   NS_LOG_FUNCTION (this);
   m_transmissionListener = new DcaTxop::TransmissionListener (this);
@@ -220,7 +239,9 @@ DcaTxop::DoDispose (void)
   delete m_transmissionListener;
   delete m_dcf;
   delete m_rng;
+  delete m_eca;
   m_transmissionListener = 0;
+  m_eca = 0;
   m_dcf = 0;
   m_rng = 0;
   m_txMiddle = 0;
@@ -232,6 +253,18 @@ DcaTxop::SetManager (Ptr<DcfManager> manager)
   NS_LOG_FUNCTION (this << manager);
   m_manager = manager;
   m_manager->Add (m_dcf);
+  SelectEcaPolicy ();
+}
+
+void
+DcaTxop::SelectEcaPolicy (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_manager == 0)
+    {
+      return;
+    }
+  m_eca = EcaPolicy::Select (m_eca, m_dcf, m_manager, m_rng, EcaPolicy::GetTraces (this), m_ecaConfig);
 }
 
 void DcaTxop::SetTxMiddle (MacTxMiddle *txMiddle)
@@ -319,7 +352,7 @@ DcaTxop::GetAifsn (void) const
 void
 DcaTxop::Queue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this << packet << &hdr);
+  HOT_LOG_FUNCTION (this << packet << &hdr);
   WifiMacTrailer fcs;
   uint32_t fullPacketSize = hdr.GetSerializedSize () + packet->GetSize () + fcs.GetSerializedSize ();
   m_stationManager->PrepareForQueue (hdr.GetAddr1 (), &hdr,
@@ -339,7 +372,7 @@ DcaTxop::AssignStreams (int64_t stream)
 void
 DcaTxop::RestartAccessIfNeeded (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if ((m_currentPacket != 0
        || !m_queue->IsEmpty ())
       && !m_dcf->IsAccessRequested ())
@@ -351,7 +384,7 @@ DcaTxop::RestartAccessIfNeeded (void)
 void
 DcaTxop::StartAccessIfNeeded (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if (m_currentPacket == 0
       && !m_queue->IsEmpty ()
       && !m_dcf->IsAccessRequested ())
@@ -363,16 +396,17 @@ DcaTxop::StartAccessIfNeeded (void)
 Ptr<MacLow>
 DcaTxop::Low (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_low;
 }
 
 bool
 DcaTxop::NeedRts (Ptr<const Packet> packet, const WifiMacHeader *header)
 {
-  NS_LOG_FUNCTION (this << packet << header);
+  HOT_LOG_FUNCTION (this << packet << header);
   return m_stationManager->NeedRts (header->GetAddr1 (), header,
-                                    packet);
+                                    packet)
+         && m_eca->IsProtectionEnabled ();
 }
 
 void
@@ -380,15 +414,14 @@ DcaTxop::DoInitialize ()
 {
   NS_LOG_FUNCTION (this);
   m_dcf->ResetCw ();
-  // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-  m_dcf->StartBackoffNow (tracedRandomFactory ());
+  m_eca->StartRandomBackoff ();
   ns3::Dcf::DoInitialize ();
 }
 
 bool
 DcaTxop::NeedRtsRetransmission (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedRtsRetransmission (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                                   m_currentPacket);
 }
@@ -396,7 +429,7 @@ DcaTxop::NeedRtsRetransmission (void)
 bool
 DcaTxop::NeedDataRetransmission (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedDataRetransmission (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                                    m_currentPacket);
 }
@@ -404,7 +437,7 @@ DcaTxop::NeedDataRetransmission (void)
 bool
 DcaTxop::NeedFragmentation (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedFragmentation (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                               m_currentPacket);
 }
@@ -472,19 +505,19 @@ DcaTxop::GetFragmentPacket (WifiMacHeader *hdr)
 bool
 DcaTxop::NeedsAccess (void) const
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return !m_queue->IsEmpty () || m_currentPacket != 0;
 }
 void
 DcaTxop::NotifyAccessGranted (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_txAttempts++;
   if (m_currentPacket == 0)
     {
       if (m_queue->IsEmpty ())
         {
-          NS_LOG_DEBUG ("queue empty");
+          HOT_LOG_DEBUG ("queue empty");
           return;
         }
       m_currentPacket = m_queue->Dequeue (&m_currentHdr);
@@ -496,7 +529,7 @@ DcaTxop::NotifyAccessGranted (void)
       m_currentHdr.SetNoMoreFragments ();
       m_currentHdr.SetNoRetry ();
       m_fragmentNumber = 0;
-      NS_LOG_DEBUG ("dequeued size=" << m_currentPacket->GetSize () <<
+      HOT_LOG_DEBUG ("dequeued size=" << m_currentPacket->GetSize () <<
                     ", to=" << m_currentHdr.GetAddr1 () <<
                     ", seq=" << m_currentHdr.GetSequenceControl ());
     }
@@ -511,7 +544,7 @@ DcaTxop::NotifyAccessGranted (void)
                                  &m_currentHdr,
                                  params,
                                  m_transmissionListener);
-      NS_LOG_DEBUG ("tx broadcast");
+      HOT_LOG_DEBUG ("tx broadcast");
     }
   else
     {
@@ -531,12 +564,12 @@ DcaTxop::NotifyAccessGranted (void)
             }
           if (IsLastFragment ())
             {
-              NS_LOG_DEBUG ("fragmenting last fragment size=" << fragment->GetSize ());
+              HOT_LOG_DEBUG ("fragmenting last fragment size=" << fragment->GetSize ());
               params.DisableNextData ();
             }
           else
             {
-              NS_LOG_DEBUG ("fragmenting size=" << fragment->GetSize ());
+              HOT_LOG_DEBUG ("fragmenting size=" << fragment->GetSize ());
               params.EnableNextData (GetNextFragmentSize ());
             }
           Low ()->StartTransmission (fragment, &hdr, params,
@@ -547,12 +580,12 @@ DcaTxop::NotifyAccessGranted (void)
           if (NeedRts (m_currentPacket, &m_currentHdr))
             {
               params.EnableRts ();
-              NS_LOG_DEBUG ("tx unicast rts");
+              HOT_LOG_DEBUG ("tx unicast rts");
             }
           else
             {
               params.DisableRts ();
-              NS_LOG_DEBUG ("tx unicast: " << m_currentPacket->GetUid ());
+              HOT_LOG_DEBUG ("tx unicast: " << m_currentPacket->GetUid ());
             }
           params.DisableNextData ();
           Low ()->StartTransmission (m_currentPacket, &m_currentHdr,
@@ -564,17 +597,16 @@ DcaTxop::NotifyAccessGranted (void)
 void
 DcaTxop::NotifyInternalCollision (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   NotifyCollision ();
 }
 
 void
 DcaTxop::NotifyCollision (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("collision");
-  // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-  m_dcf->StartBackoffNow (tracedRandomFactory ());
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("collision");
+  m_eca->NotifyCollision ();
   RestartAccessIfNeeded ();
 }
 
@@ -607,18 +639,18 @@ DcaTxop::NotifyWakeUp (void)
 void
 DcaTxop::GotCts (double snr, WifiMode txMode)
 {
-  NS_LOG_FUNCTION (this << snr << txMode);
-  NS_LOG_DEBUG ("got cts");
+  HOT_LOG_FUNCTION (this << snr << txMode);
+  HOT_LOG_DEBUG ("got cts");
 }
 
 void
 DcaTxop::MissedCts (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("missed cts");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("missed cts");
   if (!NeedRtsRetransmission ())
     {
-      NS_LOG_DEBUG ("Cts Fail");
+      HOT_LOG_DEBUG ("Cts Fail");
       m_stationManager->ReportFinalRtsFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
       if (!m_txFailedCallback.IsNull ())
         {
@@ -632,8 +664,7 @@ DcaTxop::MissedCts (void)
     {
       m_dcf->UpdateFailedCw ();
     }
-  // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-  m_dcf->StartBackoffNow (tracedRandomFactory ());
+  m_eca->StartRandomBackoff ();
   RestartAccessIfNeeded ();
 }
 
@@ -642,13 +673,11 @@ void
 DcaTxop::GotAck (double snr, WifiMode txMode)
 {
   m_successes++;
-  NS_LOG_FUNCTION (this << snr << txMode);
+  HOT_LOG_FUNCTION (this << snr << txMode);
   if (!NeedFragmentation ()
       || IsLastFragment ())
     {
-      NS_LOG_DEBUG ("got ack. tx done.");
-      AddConsecutiveSuccess();
-      m_manager->ResetStickiness ();
+      HOT_LOG_DEBUG ("got ack. tx done.");
       if (!m_txOkCallback.IsNull ())
         {
           m_txOkCallback (m_currentHdr);
@@ -659,85 +688,23 @@ DcaTxop::GotAck (double snr, WifiMode txMode)
        */
       m_currentPacket = 0;
 
-      /* Beginning  of CSMA/ECA */
-      if (m_manager->GetEnvironmentForECA ())
-        {
-          NS_LOG_DEBUG ("***ECA=true");
-          if (!m_manager->GetHysteresisForECA ())
-            m_dcf->ResetCw ();
-
-          if (m_manager->GetScheduleReset ())
-            {
-              if (m_scheduleRecentlyReduced == true)
-                KeepScheduleReductionIfAny ();
-              if (m_srActivationThreshold == 0) 
-                SetScheduleResetActivationThreshold ( (m_dcf->GetCwMax ()+ 1) / (m_dcf->GetCw () + 1) );
-
-              NS_LOG_DEBUG ("Schedule Reset. Sx #" << GetConsecutiveSuccesses ()
-                << " activation thresh: " << GetScheduleResetActivationThreshold ());
-
-              if (GetConsecutiveSuccesses () >= GetScheduleResetActivationThreshold ())
-                {
-                  if (!m_srBeingFilled)
-                    {
-                      NS_LOG_DEBUG ("Starting to fill the bitmap");
-                      SetScheduleResetThreshold ();
-                      uint32_t size = (m_dcf->GetCw () / 2) + 2; //number of elements in vector + 1
-                      m_manager->StartNewEcaBitmap (size);
-                      m_srBeingFilled = true;
-                      m_manager->SetFillingTheBitmap ();
-                      m_srIterations = GetConsecutiveSuccesses ();
-                    }
-                  else
-                    {
-                      if( (GetConsecutiveSuccesses () - m_srIterations) >= GetScheduleResetThreshold ())
-                        {
-                          NS_LOG_DEBUG ("Checking bitmap for Schedule Reset");
-                          if(CanWeReduceTheSchedule ())
-                            {
-                              NS_LOG_DEBUG ("We can reduce the schedule");
-                              ModifyCwAccordingToScheduleReduction ();
-                            }
-                          else
-                            {
-                              NS_LOG_DEBUG ("We cannot reduce the schedule");
-                            }
-                          m_srBeingFilled = false;
-                          m_manager->SetNotFillingTheBitmap ();
-                          ResetConsecutiveSuccess ();
-                          m_srIterations = GetConsecutiveSuccesses ();
-                        }
-                    }
-                } 
-            }
-
-          m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
-          NS_LOG_DEBUG ("Done processing success");
-        }
-      /* End of CSMA/ECA */
-      else
-        {
-          m_dcf->ResetCw();
-          // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-          m_dcf->StartBackoffNow (tracedRandomFactory ());
-        }
-
+      m_eca->NotifySuccess ();
       RestartAccessIfNeeded ();
     }
   else
     {
-      NS_LOG_DEBUG ("got ack. tx not done, size=" << m_currentPacket->GetSize ());
+      HOT_LOG_DEBUG ("got ack. tx not done, size=" << m_currentPacket->GetSize ());
     }
 }
 
 void
 DcaTxop::MissedAck (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("missed ack");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("missed ack");
   if (!NeedDataRetransmission ())
     {
-      NS_LOG_DEBUG ("Ack Fail");
+      HOT_LOG_DEBUG ("Ack Fail");
       m_stationManager->ReportFinalDataFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
       if (!m_txFailedCallback.IsNull ())
         {
@@ -752,25 +719,9 @@ DcaTxop::MissedAck (void)
       MY_DEBUG ("Retransmit");
       m_currentHdr.SetRetry ();
 
-      /* Reverting the Schedule Reset if any */
-      if (m_manager->GetStickiness () == 0)
+      if (m_eca->NotifyFailure ())
         {
-          MY_DEBUG ("Node's stickiness: " << m_manager->GetStickiness ());
-          if (m_manager->GetScheduleReset ())
-            ResetSrMetrics ();
-          ResetConsecutiveSuccess();
-          m_dcf->UpdateFailedCw ();
           m_failures++;
-          // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-          m_dcf->StartBackoffNow (tracedRandomFactory ());
-        }
-      else
-        {
-          NS_ASSERT (m_manager->GetStickiness () > 0);
-          MY_DEBUG ("Reducing stickiness from: " << m_manager->GetStickiness ());
-          m_manager->ReduceStickiness ();
-          MY_DEBUG ("Assigning a deterministic backoff");
-          m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
         }
     }
   RestartAccessIfNeeded ();
@@ -779,8 +730,8 @@ DcaTxop::MissedAck (void)
 void
 DcaTxop::StartNext (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("start next packet fragment");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("start next packet fragment");
   /* this callback is used only for fragments. */
   NextFragment ();
   WifiMacHeader hdr;
@@ -835,22 +786,10 @@ DcaTxop::Cancel (void)
 void
 DcaTxop::EndTxNoAck (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("a transmission that did not require an ACK just finished");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("a transmission that did not require an ACK just finished");
   m_currentPacket = 0;
-  
-  if(m_manager->GetEnvironmentForECA ())
-    {
-      if (!m_manager->GetHysteresisForECA ())
-        m_dcf->ResetCw ();
-      m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
-    }
-  else
-    {
-      m_dcf->ResetCw ();
-      // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-      m_dcf->StartBackoffNow (tracedRandomFactory ());
-    }
+  m_eca->NotifyTxNoAck ();
   StartAccessIfNeeded ();
 }
 
@@ -885,19 +824,11 @@ DcaTxop::GetAssignedBackoff (void)
 uint32_t
 DcaTxop::GetConsecutiveSuccesses (void)
 {
-  return m_consecutiveSuccess;
-}
-
-void
-DcaTxop::AddConsecutiveSuccess (void)
-{
-  m_consecutiveSuccess++;
-}
-
-void
-DcaTxop::ResetConsecutiveSuccess (void)
-{
-  m_consecutiveSuccess = 0;
+  if (m_eca == 0)
+    {
+      return 0;
+    }
+  return m_eca->GetState ().consecutiveSuccess;
 }
 
 void
@@ -910,219 +841,109 @@ DcaTxop::ResetStats (void)
   m_txAttempts = 0;
   m_boCounter = 0xFFFFFFFF;
   m_ecaBitmap = false;
-  m_consecutiveSuccess = 0;
-  m_settingThreshold = false;
-  m_scheduleResetThreshold = 0;
-  m_scheduleResetMode = false;
-  m_scheduleResetConservative = false;
-  // m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-  m_dcf->StartBackoffNow (tracedRandomFactory ());
-}
-
-uint32_t
-DcaTxop::deterministicBackoff (uint32_t cw)
-{
-  uint32_t tmp = ceil(cw / 2) + 1;
-  if(!m_settingThreshold)
+  m_ecaConfig.scheduleReduction = ECA_SR_HALVING;
+  m_ecaConfig.conservative = false;
+  m_ecaConfig.srWindow = 0;
+  m_ecaConfig.controller = false;
+  m_ecaConfig.rtsSuppressAfter = 0;
+  m_ctrlCwStepDowns = 0;
+  m_ecaRtsEnabled = true;
+  SelectEcaPolicy ();
+  if (m_eca == 0)
     {
-      m_boCounter = 0xFFFFFFFF;
-      m_boCounter = tmp;
+      return;
     }
-  m_settingThreshold = false;
-  return tmp;
-}
-
-uint32_t
-DcaTxop::tracedRandomFactory (void)
-{
-  m_boCounter = 0xFFFFFFFF;
-  m_boCounter = m_rng->GetNext (0, m_dcf->GetCw ());
-  // NS_LOG_DEBUG ("Setting random backoff using CSMA/ECA: " << m_boCounter);
-  return m_boCounter;
+  m_eca->ResetState ();
+  m_eca->StartRandomBackoff ();
 }
 
 bool
 DcaTxop::GetScheduleResetMode (void)
 {
-  return m_scheduleResetMode;
+  return m_ecaConfig.scheduleReduction == ECA_SR_RESET;
 }
 
 void
 DcaTxop::SetScheduleResetMode (void)
 {
-  m_scheduleResetMode = true;
+  m_ecaConfig.scheduleReduction = ECA_SR_RESET;
+  SelectEcaPolicy ();
 }
 
-bool
-DcaTxop::CanWeReduceTheSchedule (void)
-{
-  bool canI = false;
-  std::vector<bool> *bitmap = m_manager->GetBitmap ();
-  NS_LOG_DEBUG ("Got the bitmap from DcfManager " << bitmap->size ());
-  
-  /* Updating the traced value */
-  m_ecaBitmap = (std::vector<bool>*) 0;
-  m_ecaBitmap = bitmap;
-
-  /* Checking the possibility of a schedule reduction */
-  uint32_t currentSize = bitmap->size ();
-  if (!GetScheduleResetMode ())
-    {
-      /* That is, a Schedule Halving */
-      /* Debugging the bitmap */
-      NS_LOG_DEBUG ("Checking for Schedule Halving");
-      uint32_t slot = 0; 
-      for (std::vector<bool>::iterator i = bitmap->begin (); i != bitmap->end (); i++, slot++)
-        {
-          NS_LOG_DEBUG ("Bitmap position " << slot << " value: " << *i);
-        }
-      /* End of debug */
-
-      if (!bitmap->at (currentSize/2 - 1))
-        {
-          NS_LOG_DEBUG ("A schedule halving is possible. Size: " << currentSize );
-          canI = true;
-          m_srReductionFactor = 2;
-        }
-    }
-  else
-    {
-      /* Debugging the bitmap */
-      NS_LOG_DEBUG ("Checking for Schedule Reset");
-      uint32_t slot = 0; 
-      for (std::vector<bool>::iterator i = bitmap->begin (); i != bitmap->end (); i++, slot++)
-        {
-          NS_LOG_DEBUG ("Bitmap position " << slot << " value: " << *i);
-        }
-      /* End of debug */
-      
-
-      uint32_t maxStage =  log2 ((m_dcf->GetCw () + 1) / (m_dcf->GetCwMin () + 1));
-      if(maxStage > 1)
-        {
-          for (uint32_t i = 0; i <= maxStage; i++)
-            {
-              uint32_t position = pow (2,i) * m_dcf->GetCwMin () / 2;
-              NS_ASSERT (position < currentSize);
-              if (!bitmap->at (position))
-              {
-                NS_LOG_DEBUG ("A schedule reset is possible. Position: " << position );
-                canI = true;
-                m_srReductionFactor = (m_dcf->GetCw () + 1) / (pow (2,i) * m_dcf->GetCwMin () + 1);
-                break;
-              }
-            }
-        }
-        else if (maxStage == 1)
-        {
-          canI = true;
-          m_srReductionFactor = 1;
-        }
-    }
-
-  /* Updating traced values */
-  m_scheduleReductionAttempts++;
-  if (canI == true)
-    {
-      m_scheduleReductions++;
-    }
-  else
-    {
-      m_scheduleReductionFailed++;
-    }
-  /* Done updating */
-  return canI;
+void
+DcaTxop::SetScheduleReductionWindow (uint32_t cycles)
+{
+  NS_LOG_FUNCTION (this << cycles);
+  m_ecaConfig.srWindow = cycles;
+  SelectEcaPolicy ();
 }
 
-uint32_t
-DcaTxop::GetScheduleResetThreshold (void)
+void
+DcaTxop::SetEcaController (double targetEmptySlots, double targetCollisions,
+                           uint32_t window, uint32_t maxStickiness)
 {
-  return m_scheduleResetThreshold;
+  NS_LOG_FUNCTION (this << targetEmptySlots << targetCollisions << window << maxStickiness);
+  NS_ASSERT (window > 0);
+  m_ecaConfig.controller = true;
+  m_ecaConfig.targetEmptySlots = targetEmptySlots;
+  m_ecaConfig.targetCollisions = targetCollisions;
+  m_ecaConfig.controllerWindow = window;
+  m_ecaConfig.maxStickiness = maxStickiness;
+  SelectEcaPolicy ();
 }
 
 void
-DcaTxop::SetScheduleResetThreshold (void)
+DcaTxop::SetEcaRtsSuppression (uint32_t successes)
 {
-  m_settingThreshold = true;
-
-  if(m_scheduleResetConservative)
-    {
-      m_scheduleResetThreshold = ceil (((m_dcf->GetCwMax () + 1) / 2) / 
-        ( deterministicBackoff (m_dcf->GetCw ())));
-    }
-  else
-    {
-      m_scheduleResetThreshold = 1;
-    }
+  NS_LOG_FUNCTION (this << successes);
+  m_ecaConfig.rtsSuppressAfter = successes;
+  SelectEcaPolicy ();
 }
 
 void
 DcaTxop::SetScheduleConservative (void)
 {
-  m_scheduleResetConservative = true;
+  m_ecaConfig.conservative = true;
+  SelectEcaPolicy ();
 }
 
 void 
 DcaTxop::SetScheduleResetActivationThreshold (uint32_t thresh)
 {
-  m_srActivationThreshold = thresh;
+  m_ecaConfig.srActivationThreshold = thresh;
+  if (m_eca != 0)
+    {
+      m_eca->SetScheduleResetActivationThreshold (thresh);
+    }
 }
 
 uint32_t
 DcaTxop::GetScheduleResetActivationThreshold (void)
 {
-  return m_srActivationThreshold;
-}
-
-void
-DcaTxop::ModifyCwAccordingToScheduleReduction (void)
-{
-  m_srPreviousCw =  m_dcf->GetCw ();
-  uint32_t factor = GetScheduleReductionFactor ();
-  NS_ASSERT (factor > 0);
-
-  uint32_t reduced = ((m_dcf->GetCw () + 1) / factor) - 1;
-
-  if(reduced > m_dcf->GetCwMin ())
-    {
-      m_dcf->SetCw (reduced);
-    }
-  else
+  if (m_eca == 0)
     {
-      m_dcf->SetCw (m_dcf->GetCwMin ());
+      return m_ecaConfig.srActivationThreshold;
     }
-
-  NS_LOG_DEBUG ("Schedule Reset modified Cw from: " << m_srPreviousCw << " to: " << m_dcf->GetCw ());
-
-  if (m_manager->UseDynamicStickiness ())
-    m_manager->IncreaseStickiness ();
-  m_scheduleRecentlyReduced = true;
+  return m_eca->GetState ().srActivationThreshold;
 }
 
-uint32_t
-DcaTxop::GetScheduleReductionFactor (void)
+EcaTxopSnapshot
+DcaTxop::GetEcaSnapshot (void) const
 {
-  return m_srReductionFactor;
+  NS_ASSERT_MSG (m_eca != 0, "No CSMA/ECA state before SetManager");
+  EcaTxopSnapshot snapshot;
+  snapshot.dcf = m_dcf->GetSnapshot ();
+  m_eca->SaveSnapshot (&snapshot);
+  return snapshot;
 }
 
 void
-DcaTxop::ResetSrMetrics (void)
+DcaTxop::RestoreEcaSnapshot (const EcaTxopSnapshot &snapshot)
 {
-  m_srBeingFilled = false;
-  m_manager->SetNotFillingTheBitmap ();
-  if (m_scheduleRecentlyReduced == true)
-    {
-      MY_DEBUG ("Resetting the chances made by Schedule Reset. Cw back to: " << m_srPreviousCw);
-      m_dcf->SetCw (m_srPreviousCw);
-    }
-  m_scheduleRecentlyReduced = false;
-}
-
-void
-DcaTxop::KeepScheduleReductionIfAny (void)
-{
-  m_scheduleRecentlyReduced = false;
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_eca != 0, "No CSMA/ECA state before SetManager");
+  m_dcf->RestoreSnapshot (snapshot.dcf);
+  m_eca->RestoreSnapshot (snapshot);
 }
 
-
 } //namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/wifi-mode.h"
 #include "ns3/wifi-remote-station-manager.h"
 #include "ns3/dcf.h"
+#include "eca-policy.h"
  //Adding the capability of functioning as a trace source
  #include "ns3/traced-value.h"
  #include "ns3/trace-source-accessor.h"
@@ -39,6 +40,7 @@ namespace ns3 {
 
 class DcfState;
 class DcfManager;
+struct EcaTxopSnapshot;
 class WifiMacQueue;
 class MacLow;
 class WifiMacParameters;
@@ -166,23 +168,46 @@ public:
   uint64_t GetTxAttempts (void);
   uint32_t GetAssignedBackoff (void);
   void ResetStats (void);
-  uint32_t deterministicBackoff (uint32_t cw);
-  uint32_t tracedRandomFactory (void);
-  bool CanWeReduceTheSchedule (void);
   uint32_t GetConsecutiveSuccesses (void);
-  void AddConsecutiveSuccess (void);
-  void ResetConsecutiveSuccess (void);
-  uint32_t GetScheduleResetThreshold (void);
-  void SetScheduleResetThreshold (void);
   void SetScheduleConservative (void);
   bool GetScheduleResetMode (void);
   void SetScheduleResetActivationThreshold (uint32_t thresh);
   uint32_t GetScheduleResetActivationThreshold (void);
   void SetScheduleResetMode (void);
-  void ModifyCwAccordingToScheduleReduction (void);
-  uint32_t GetScheduleReductionFactor (void);
-  void ResetSrMetrics (void);
-  void KeepScheduleReductionIfAny (void);
+  /**
+   * Check the schedule after every success against the slots used
+   * in the last \p cycles cycles, instead of filling and checking one
+   * bitmap at a time.
+   *
+   * \param cycles the number of cycles in the window, 0 to disable
+   */
+  void SetScheduleReductionWindow (uint32_t cycles);
+  /**
+   * Let CSMA/ECA adapt its stickiness and step the CW down from the
+   * slots observed during the backoff. Every \p window transmissions,
+   * stickiness is lowered if the failure rate exceeds
+   * \p targetCollisions and raised (up to \p maxStickiness) otherwise.
+   * In that case, if more than \p targetEmptySlots of the slots were
+   * empty, the CW drops one stage.
+   *
+   * \param targetEmptySlots empty slot fraction target
+   * \param targetCollisions failure rate target
+   * \param window transmissions per decision
+   * \param maxStickiness upper bound of the stickiness
+   */
+  void SetEcaController (double targetEmptySlots, double targetCollisions,
+                         uint32_t window, uint32_t maxStickiness);
+  /**
+   * Only let RTS/CTS protect transmissions while CSMA/ECA is not on a
+   * collision-free deterministic schedule: protection is switched off
+   * after \p successes successes without failures, and back on by the
+   * next failure or collision.
+   *
+   * \param successes successes before switching RTS/CTS off, 0 to disable
+   */
+  void SetEcaRtsSuppression (uint32_t successes);
+  EcaTxopSnapshot GetEcaSnapshot (void) const;
+  void RestoreEcaSnapshot (const EcaTxopSnapshot &snapshot);
 
   //For tracing the bitmap
   typedef void (* TracedEcaBitmap) (std::vector<bool> *bmold, std::vector<bool> *bmnew); 
@@ -194,6 +219,7 @@ private:
   class Dcf;
   friend class Dcf;
   friend class TransmissionListener;
+  friend class EcaPolicy;
 
   DcaTxop &operator = (const DcaTxop &);
   DcaTxop (const DcaTxop &o);
@@ -359,6 +385,11 @@ private:
    * \return the fragment with the current fragment number
    */
   Ptr<Packet> GetFragmentPacket (WifiMacHeader *hdr);
+  /**
+   * Build the CSMA/ECA policy matching the DcfManager environment
+   * and the schedule reduction settings, keeping the current state.
+   */
+  void SelectEcaPolicy (void);
 
   virtual void DoDispose (void);
 
@@ -378,18 +409,9 @@ private:
   WifiMacHeader m_currentHdr;
   uint8_t m_fragmentNumber;
 
-  uint32_t m_consecutiveSuccess;
-  bool m_settingThreshold;
-  uint32_t m_scheduleResetThreshold;
-  bool m_scheduleResetConservative;
-  bool m_scheduleResetMode;
-  uint32_t m_srActivationThreshold;
-  bool m_srBeingFilled;
-  uint32_t m_srIterations;
-  uint32_t m_srReductionFactor;
-  bool m_scheduleRecentlyReduced;
-  uint32_t m_srPreviousCw;
- 
+  EcaPolicy *m_eca;            //!< 0 until SetManager
+  EcaPolicyConfig m_ecaConfig; //!< CSMA/ECA settings of this transmitter
+
   TracedValue<uint64_t> m_failures;
   TracedValue<uint64_t> m_successes;
   TracedValue<uint64_t> m_txAttempts;
@@ -398,6 +420,11 @@ private:
   TracedValue<uint32_t> m_scheduleReductions;
   TracedValue<uint32_t> m_scheduleReductionAttempts;
   TracedValue<uint32_t> m_scheduleReductionFailed;
+  TracedValue<double> m_ctrlEmptySlots;
+  TracedValue<double> m_ctrlCollisionRate;
+  TracedValue<uint32_t> m_ctrlStickiness;
+  TracedValue<uint32_t> m_ctrlCwStepDowns;
+  TracedValue<bool> m_ecaRtsEnabled;
 
 
 };
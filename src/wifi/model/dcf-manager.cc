@@ -23,13 +23,13 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <cmath>
+#include <algorithm>
+#include <limits>
 #include "dcf-manager.h"
 #include "wifi-phy.h"
 #include "wifi-mac.h"
 #include "mac-low.h"
-
-#define MY_DEBUG(x) \
-  NS_LOG_DEBUG (Simulator::Now () << " " << this << " " << x)
+#include "hot-log.h"
 
 namespace ns3 {
 
@@ -45,7 +45,11 @@ DcfState::DcfState ()
     m_cwMin (0),
     m_cwMax (0),
     m_cw (0),
-    m_accessRequested (false)
+    m_accessRequested (false),
+    m_areWeFillingTheBitmap (false),
+    m_idleSlots (0),
+    m_busySlots (0),
+    m_lastSlotBusy (false)
 {
 }
 
@@ -118,6 +122,21 @@ DcfState::UpdateBackoffSlotsNow (uint32_t nSlots, Time backoffUpdateBound)
   MY_DEBUG ("update slots=" << nSlots << " slots, backoff=" << m_backoffSlots);
 }
 
+void
+DcfState::NotifySlotsObserved (uint32_t idleSlots, bool busy)
+{
+  m_idleSlots += idleSlots;
+  if (idleSlots > 0)
+    {
+      m_lastSlotBusy = false;
+    }
+  if (busy && !m_lastSlotBusy)
+    {
+      m_busySlots++;
+      m_lastSlotBusy = true;
+    }
+}
+
 void
 DcfState::StartBackoffNow (uint32_t nSlots)
 {
@@ -150,6 +169,73 @@ DcfState::IsAccessRequested (void) const
 {
   return m_accessRequested;
 }
+
+DcfStateSnapshot
+DcfState::GetSnapshot (void) const
+{
+  DcfStateSnapshot snapshot;
+  snapshot.cw = m_cw;
+  snapshot.backoffSlots = m_backoffSlots;
+  snapshot.fillingTheBitmap = m_areWeFillingTheBitmap;
+  snapshot.bitmap = m_ecaBitmap;
+  return snapshot;
+}
+
+void
+DcfState::RestoreSnapshot (const DcfStateSnapshot &snapshot)
+{
+  NS_ASSERT (!m_accessRequested);
+  NS_ASSERT (snapshot.cw >= m_cwMin && snapshot.cw <= m_cwMax);
+  MY_DEBUG ("restore cw=" << snapshot.cw << ", backoff=" << snapshot.backoffSlots << " slots");
+  m_cw = snapshot.cw;
+  m_backoffSlots = snapshot.backoffSlots;
+  m_backoffStart = Simulator::Now ();
+  m_areWeFillingTheBitmap = snapshot.fillingTheBitmap;
+  m_ecaBitmap = snapshot.bitmap;
+}
+
+void
+DcfState::StartNewEcaBitmap (uint32_t size)
+{
+  MY_DEBUG ("Creating new bitmap of size :" << size);
+  m_ecaBitmap.assign (size, false);
+}
+
+std::vector<bool>*
+DcfState::GetBitmap (void)
+{
+  return &m_ecaBitmap;
+}
+
+bool
+DcfState::AreWeFillingTheBitmap (void) const
+{
+  return m_areWeFillingTheBitmap;
+}
+
+void
+DcfState::SetFillingTheBitmap (void)
+{
+  m_areWeFillingTheBitmap = true;
+}
+
+void
+DcfState::SetNotFillingTheBitmap (void)
+{
+  m_areWeFillingTheBitmap = false;
+}
+
+uint64_t
+DcfState::GetIdleSlots (void) const
+{
+  return m_idleSlots;
+}
+
+uint64_t
+DcfState::GetBusySlots (void) const
+{
+  return m_busySlots;
+}
 void
 DcfState::NotifyAccessRequested (void)
 {
@@ -194,6 +280,17 @@ DcfState::NotifyWakeUp (void)
   DoNotifyWakeUp ();
 }
 
+void
+DcfState::NotifyEcaConfigChanged (void)
+{
+  DoNotifyEcaConfigChanged ();
+}
+
+void
+DcfState::DoNotifyEcaConfigChanged (void)
+{
+}
+
 
 /**
  * Listener for NAV events. Forwards to DcfManager
@@ -346,12 +443,21 @@ DcfManager::DcfManager ()
     m_isNextSlotBusy (false),
     m_stickiness (0),
     m_resetStickiness (0),
+    m_configuredStickiness (0),
+    m_ecaController (0),
     m_dynamicStickiness (false),
-    m_areWeFillingTheBitmap (false),
     m_ecaFairShare (false),
+    m_slotStatsBusy (false),
+    m_slotStatsBusyStart (MicroSeconds (0)),
+    m_slotStatsBusyEnd (MicroSeconds (0)),
+    m_slotStatsRxOk (false),
+    m_slotStatsRxError (false),
+    m_slotStatsTimeout (false),
+    m_slotStatsStale (false),
     m_lastTracedTxDuration (0xFFFFFFFFFFFFFFFF)
 {
   NS_LOG_FUNCTION (this);
+  ResetSlotStats ();
 }
 
 DcfManager::~DcfManager ()
@@ -436,14 +542,14 @@ DcfManager::Add (DcfState *dcf)
 Time
 DcfManager::MostRecent (Time a, Time b) const
 {
-  NS_LOG_FUNCTION (this << a << b);
+  HOT_LOG_FUNCTION (this << a << b);
   return Max (a, b);
 }
 
 Time
 DcfManager::MostRecent (Time a, Time b, Time c) const
 {
-  NS_LOG_FUNCTION (this << a << b << c);
+  HOT_LOG_FUNCTION (this << a << b << c);
   Time retval;
   retval = Max (a, b);
   retval = Max (retval, c);
@@ -453,7 +559,7 @@ DcfManager::MostRecent (Time a, Time b, Time c) const
 Time
 DcfManager::MostRecent (Time a, Time b, Time c, Time d) const
 {
-  NS_LOG_FUNCTION (this << a << b << c << d);
+  HOT_LOG_FUNCTION (this << a << b << c << d);
   Time e = Max (a, b);
   Time f = Max (c, d);
   Time retval = Max (e, f);
@@ -463,7 +569,7 @@ DcfManager::MostRecent (Time a, Time b, Time c, Time d) const
 Time
 DcfManager::MostRecent (Time a, Time b, Time c, Time d, Time e, Time f) const
 {
-  NS_LOG_FUNCTION (this << a << b << c << d << e << f);
+  HOT_LOG_FUNCTION (this << a << b << c << d << e << f);
   Time g = Max (a, b);
   Time h = Max (c, d);
   Time i = Max (e, f);
@@ -475,7 +581,7 @@ DcfManager::MostRecent (Time a, Time b, Time c, Time d, Time e, Time f) const
 Time
 DcfManager::MostRecent (Time a, Time b, Time c, Time d, Time e, Time f, Time g) const
 {
-  NS_LOG_FUNCTION (this << a << b << c << d << e << f << g);
+  HOT_LOG_FUNCTION (this << a << b << c << d << e << f << g);
   Time h = Max (a, b);
   Time i = Max (c, d);
   Time j = Max (e, f);
@@ -488,7 +594,7 @@ DcfManager::MostRecent (Time a, Time b, Time c, Time d, Time e, Time f, Time g)
 bool
 DcfManager::IsBusy (void) const
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   // PHY busy
   if (m_rxing)
     {
@@ -511,7 +617,7 @@ DcfManager::IsBusy (void) const
 void
 DcfManager::RequestAccess (DcfState *state)
 {
-  NS_LOG_FUNCTION (this << state);
+  HOT_LOG_FUNCTION (this << state);
   //Deny access if in sleep mode
   if (m_sleeping)
     {
@@ -545,7 +651,7 @@ DcfManager::RequestAccess (DcfState *state)
 void
 DcfManager::DoGrantAccess (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   uint32_t k = 0;
   for (States::const_iterator i = m_states.begin (); i != m_states.end (); k++)
     {
@@ -600,7 +706,7 @@ DcfManager::DoGrantAccess (void)
 void
 DcfManager::AccessTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_isNextSlotBusy = false;
   UpdateBackoff ();
   DoGrantAccess ();
@@ -610,7 +716,7 @@ DcfManager::AccessTimeout (void)
 Time
 DcfManager::GetAccessGrantStart (void) const
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   Time rxAccessStart;
   if (!m_rxing)
     {
@@ -638,7 +744,7 @@ DcfManager::GetAccessGrantStart (void) const
                                         ctsTimeoutAccessStart,
                                         switchingAccessStart
                                         );
-  NS_LOG_INFO ("access grant start=" << accessGrantedStart <<
+  HOT_LOG_INFO ("access grant start=" << accessGrantedStart <<
                ", rx access start=" << rxAccessStart <<
                ", busy access start=" << busyAccessStart <<
                ", tx access start=" << txAccessStart <<
@@ -649,7 +755,7 @@ DcfManager::GetAccessGrantStart (void) const
 Time
 DcfManager::GetBackoffStartFor (DcfState *state)
 {
-  NS_LOG_FUNCTION (this << state);
+  HOT_LOG_FUNCTION (this << state);
   Time mostRecentEvent = MostRecent (state->GetBackoffStart (),
                                      GetAccessGrantStart () + MicroSeconds (state->GetAifsn () * m_slotTimeUs));
 
@@ -667,7 +773,8 @@ DcfManager::GetBackoffEndFor (DcfState *state)
 void
 DcfManager::UpdateBackoff (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
+  bool bitmapUpdated = false;
   uint32_t k = 0;
   for (States::const_iterator i = m_states.begin (); i != m_states.end (); i++, k++)
     {
@@ -679,25 +786,35 @@ DcfManager::UpdateBackoff (void)
           uint32_t nus = (Simulator::Now () - backoffStart).GetMicroSeconds ();
           uint32_t nIntSlots = nus / m_slotTimeUs;
           uint32_t n = std::min (nIntSlots, state->GetBackoffSlots ());
-          NS_LOG_DEBUG ("dcf " << k << " dec backoff slots=" << n);
+          HOT_LOG_DEBUG ("dcf " << k << " dec backoff slots=" << n);
           Time backoffUpdateBound = backoffStart + MicroSeconds (n * m_slotTimeUs);
           state->UpdateBackoffSlotsNow (n, backoffUpdateBound);
+          if (n > 0 || state->GetBackoffSlots () > 0)
+            {
+              state->NotifySlotsObserved (n, m_isNextSlotBusy);
+            }
           
           if (GetEnvironmentForECA () == true && GetScheduleReset ())
             {
-              if (AreWeFillingTheBitmap () && k == 3)
+              if (state->AreWeFillingTheBitmap ())
                 {
                   UpdateEcaBitmap (state);
+                  bitmapUpdated = true;
                 }
             }
         }
     }
+  /* The busy slot is shared by every DcfState filling a bitmap */
+  if (bitmapUpdated)
+    {
+      m_isNextSlotBusy = false;
+    }
 }
 
 void
 DcfManager::DoRestartAccessTimeoutIfNeeded (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   /**
    * Is there a DcfState which needs to access the medium, and,
    * if there is one, how many slots for AIFS+backoff does it require ?
@@ -737,11 +854,12 @@ DcfManager::DoRestartAccessTimeoutIfNeeded (void)
 void
 DcfManager::NotifyRxStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
-  NS_LOG_DEBUG ("rx start for=" << duration);
+  HOT_LOG_FUNCTION (this << duration);
+  HOT_LOG_DEBUG ("rx start for=" << duration);
 
   m_isNextSlotBusy = true;
   UpdateBackoff ();
+  UpdateSlotStatsBusy (duration);
   m_lastRxStart = Simulator::Now ();
   m_lastRxDuration = duration;
   m_rxing = true;
@@ -750,8 +868,9 @@ DcfManager::NotifyRxStartNow (Time duration)
 void
 DcfManager::NotifyRxEndOkNow (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("rx end ok");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("rx end ok");
+  m_slotStatsRxOk = true;
   m_lastRxEnd = Simulator::Now ();
   m_lastRxReceivedOk = true;
   m_rxing = false;
@@ -760,8 +879,9 @@ DcfManager::NotifyRxEndOkNow (void)
 void
 DcfManager::NotifyRxEndErrorNow (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("rx end error");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("rx end error");
+  m_slotStatsRxError = true;
   m_lastRxEnd = Simulator::Now ();
   m_lastRxReceivedOk = false;
   m_rxing = false;
@@ -770,7 +890,7 @@ DcfManager::NotifyRxEndErrorNow (void)
 void
 DcfManager::NotifyTxStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   if (m_rxing)
     {
       //this may be caused only if PHY has started to receive a packet
@@ -784,6 +904,8 @@ DcfManager::NotifyTxStartNow (Time duration)
     }
   MY_DEBUG ("tx start for " << duration);
   UpdateBackoff ();
+  UpdateSlotStatsBusy (duration);
+  m_slotStats.ownTransmissions++;
   m_lastTxStart = Simulator::Now ();
   m_lastTxDuration = duration;
   UpdateTracedTxDuration();
@@ -792,9 +914,10 @@ DcfManager::NotifyTxStartNow (Time duration)
 void
 DcfManager::NotifyMaybeCcaBusyStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   MY_DEBUG ("busy start for " << duration);
   UpdateBackoff ();
+  UpdateSlotStatsBusy (duration);
 
   m_isNextSlotBusy = true;
   m_lastBusyStart = Simulator::Now ();
@@ -903,7 +1026,7 @@ DcfManager::NotifyWakeupNow (void)
 void
 DcfManager::NotifyNavResetNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   MY_DEBUG ("nav reset for=" << duration);
   UpdateBackoff ();
   m_lastNavStart = Simulator::Now ();
@@ -921,7 +1044,7 @@ DcfManager::NotifyNavResetNow (Time duration)
 void
 DcfManager::NotifyNavStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   NS_ASSERT (m_lastNavStart <= Simulator::Now ());
   MY_DEBUG ("nav start for=" << duration);
   UpdateBackoff ();
@@ -937,31 +1060,35 @@ DcfManager::NotifyNavStartNow (Time duration)
 void
 DcfManager::NotifyAckTimeoutStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   NS_ASSERT (m_lastAckTimeoutEnd < Simulator::Now ());
   m_lastAckTimeoutEnd = Simulator::Now () + duration;
+  m_slotStatsTimeout = true;
 }
 
 void
 DcfManager::NotifyAckTimeoutResetNow ()
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_lastAckTimeoutEnd = Simulator::Now ();
+  m_slotStatsTimeout = false;
   DoRestartAccessTimeoutIfNeeded ();
 }
 
 void
 DcfManager::NotifyCtsTimeoutStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  HOT_LOG_FUNCTION (this << duration);
   m_lastCtsTimeoutEnd = Simulator::Now () + duration;
+  m_slotStatsTimeout = true;
 }
 
 void
 DcfManager::NotifyCtsTimeoutResetNow ()
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_lastCtsTimeoutEnd = Simulator::Now ();
+  m_slotStatsTimeout = false;
   DoRestartAccessTimeoutIfNeeded ();
 }
   /**
@@ -980,8 +1107,13 @@ DcfManager::SetEnvironmentForECA (bool hysteresis, bool scheduleReset, uint32_t
   m_dynamicStickiness = dynStick;
   m_stickiness = stickiness;
   m_resetStickiness = stickiness;
+  m_configuredStickiness = stickiness;
   m_scheduleReset = scheduleReset;
   NS_LOG_DEBUG ("Setting Schedule Reset: " << m_scheduleReset);
+  for (States::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      (*i)->NotifyEcaConfigChanged ();
+    }
 }
 
 bool
@@ -1003,31 +1135,16 @@ DcfManager::UpdateTracedTxDuration()
   m_lastTracedTxDuration = m_lastTxDuration.GetMicroSeconds();
 }
 
-void 
-DcfManager::StartNewEcaBitmap (uint32_t size)
-{
-  if(m_ecaBitmap.size () > 0)
-    m_ecaBitmap.clear ();
-
-  NS_LOG_DEBUG ("Creating new bitmap of size :" << size);
-  m_ecaBitmap.assign(size, false);
-}
-
-std::vector<bool>* 
-DcfManager::GetBitmap (void)
-{
-  return &m_ecaBitmap;
-}
-
 void 
 DcfManager::UpdateEcaBitmap (DcfState *state)
 {
+  std::vector<bool> *bitmap = state->GetBitmap ();
   uint32_t position = GetCurrentBitmapPosition (state);
-  MY_DEBUG ("pos: " << position << ". size: " << m_ecaBitmap.size ());
-  NS_ASSERT (position < m_ecaBitmap.size ());
+  MY_DEBUG ("pos: " << position << ". size: " << bitmap->size ());
+  NS_ASSERT (position < bitmap->size ());
   if (isNextSlotBusy ())
     {
-      m_ecaBitmap.at(position) = true;
+      bitmap->at (position) = true;
       MY_DEBUG ("marking bitmap position: " << position << " as busy");
     }
   else
@@ -1035,11 +1152,7 @@ DcfManager::UpdateEcaBitmap (DcfState *state)
         MY_DEBUG ("Slot #" << position << " was free");
     }
 
-  // std::cout << "Marking position: " << position << " as " << m_ecaBitmap.at (position) << std::endl;
-  // std::cout << "Current Backoff: " << state->GetBackoffSlots () << std::endl;
-
   MY_DEBUG ("Remaining backoff slots: " << state->GetBackoffSlots ());
-  m_isNextSlotBusy = false;
 }
 
 uint32_t
@@ -1050,14 +1163,14 @@ DcfManager::GetCurrentBitmapPosition (DcfState *state)
     NS_ASSERT (m_scheduleReset);
     uint32_t position = 0;
     position = state->GetBackoffSlots ();
-    MY_DEBUG ("pos: " << position << ". size: " << m_ecaBitmap.size ());
-    NS_ASSERT (position < m_ecaBitmap.size ());
+    MY_DEBUG ("pos: " << position << ". size: " << state->GetBitmap ()->size ());
+    NS_ASSERT (position < state->GetBitmap ()->size ());
     return position;
   }
   else
     {
       MY_DEBUG ("Not doing Schedule Reset");
-      return m_ecaBitmap.size ();
+      return state->GetBitmap ()->size ();
     }
 }
 
@@ -1106,27 +1219,46 @@ DcfManager::IncreaseStickiness (void)
   std::min(m_stickiness + 1, maxStickiness);
 }
 
-bool
-DcfManager::UseDynamicStickiness (void)
+void
+DcfManager::SetStickiness (uint32_t stickiness)
 {
-  return m_dynamicStickiness;
+  NS_LOG_FUNCTION (this << stickiness);
+  m_resetStickiness = stickiness;
+  m_stickiness = std::min (m_stickiness, stickiness);
+}
+
+uint32_t
+DcfManager::GetConfiguredStickiness (void) const
+{
+  return m_configuredStickiness;
 }
 
 bool
-DcfManager::AreWeFillingTheBitmap (void)
+DcfManager::AcquireEcaController (DcfState *state)
 {
-  return m_areWeFillingTheBitmap;
-}  
-void 
-DcfManager::SetFillingTheBitmap (void)
+  NS_LOG_FUNCTION (this << state);
+  if (m_ecaController != 0 && m_ecaController != state)
+    {
+      return false;
+    }
+  m_ecaController = state;
+  return true;
+}
+
+void
+DcfManager::ReleaseEcaController (DcfState *state)
 {
-  m_areWeFillingTheBitmap = true;
+  NS_LOG_FUNCTION (this << state);
+  if (m_ecaController == state)
+    {
+      m_ecaController = 0;
+    }
 }
 
-void 
-DcfManager::SetNotFillingTheBitmap (void)
+bool
+DcfManager::UseDynamicStickiness (void)
 {
-  m_areWeFillingTheBitmap = false;
+  return m_dynamicStickiness;
 }
 
 void
@@ -1141,4 +1273,157 @@ DcfManager::GetAmpduSimulation (void)
   return m_ecaFairShare;
 }
 
+DcfManagerEcaSnapshot
+DcfManager::GetEcaSnapshot (void) const
+{
+  DcfManagerEcaSnapshot snapshot;
+  snapshot.stickiness = m_stickiness;
+  return snapshot;
+}
+
+void
+DcfManager::RestoreEcaSnapshot (const DcfManagerEcaSnapshot &snapshot)
+{
+  NS_LOG_FUNCTION (this << snapshot.stickiness);
+  m_stickiness = snapshot.stickiness;
+  m_isNextSlotBusy = false;
+}
+
+static void
+AddToHistogram (std::vector<uint64_t> &histogram, uint64_t value)
+{
+  if (!histogram.empty ())
+    {
+      histogram[std::min<uint64_t> (value, histogram.size () - 1)]++;
+    }
+}
+
+void
+DcfManager::UpdateSlotStatsBusy (Time duration)
+{
+  if (m_slotTimeUs == 0)
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  if (m_slotStatsBusy)
+    {
+      /* The SIFS inside a frame exchange can be longer than a slot
+       * (16 us against 9 us at 5 GHz), so only a gap of more than SIFS
+       * plus a slot ends the busy period */
+      if (now < m_slotStatsBusyEnd + m_sifs + MicroSeconds (m_slotTimeUs))
+        {
+          /* Same busy period (e.g., DATA and ACK) */
+          m_slotStatsBusyEnd = Max (m_slotStatsBusyEnd, now + duration);
+          return;
+        }
+      CloseSlotStatsPeriod ();
+      Time idleStart = GetSlotStatsIdleStart ();
+      uint64_t idle = 0;
+      if (now > idleStart)
+        {
+          idle = (now - idleStart).GetMicroSeconds () / m_slotTimeUs;
+        }
+      m_slotStats.idleSlots += idle;
+      AddToHistogram (m_slotStats.idleRunHistogram, idle);
+    }
+  m_slotStatsBusy = true;
+  m_slotStatsBusyStart = now;
+  m_slotStatsBusyEnd = now + duration;
+  m_slotStatsRxOk = false;
+  m_slotStatsRxError = false;
+  m_slotStatsTimeout = false;
+  m_slotStatsStale = false;
+  m_slotStats.busyPeriods++;
+}
+
+Time
+DcfManager::GetSlotStatsIdleStart (void) const
+{
+  /* Nobody counts down a backoff slot before its AIFS (or EIFS) ends */
+  uint32_t aifsn = m_states.empty () ? 2 : std::numeric_limits<uint32_t>::max ();
+  for (States::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      aifsn = std::min (aifsn, (*i)->GetAifsn ());
+    }
+  Time idleStart = m_slotStatsBusyEnd + m_sifs + MicroSeconds (aifsn * m_slotTimeUs);
+  if (m_slotStatsRxError && !m_slotStatsRxOk)
+    {
+      idleStart += m_eifsNoDifs;
+    }
+  return idleStart;
+}
+
+void
+DcfManager::CloseSlotStatsPeriod (void)
+{
+  if (m_slotStatsStale)
+    {
+      return;
+    }
+  if (m_slotStatsRxOk)
+    {
+      m_slotStats.successPeriods++;
+    }
+  else if (m_slotStatsRxError || m_slotStatsTimeout)
+    {
+      m_slotStats.collisionPeriods++;
+    }
+  else
+    {
+      m_slotStats.otherPeriods++;
+    }
+  Time length = m_slotStatsBusyEnd - m_slotStatsBusyStart;
+  m_slotStats.busyTime += length;
+  AddToHistogram (m_slotStats.busyLengthHistogram,
+                  (length.GetMicroSeconds () + m_slotTimeUs - 1) / m_slotTimeUs);
+}
+
+void
+DcfManager::EnableSlotHistograms (uint32_t bins)
+{
+  NS_LOG_FUNCTION (this << bins);
+  m_slotStats.idleRunHistogram.assign (bins, 0);
+  m_slotStats.busyLengthHistogram.assign (bins, 0);
+}
+
+DcfSlotStats
+DcfManager::GetSlotStats (void) const
+{
+  return m_slotStats;
+}
+
+void
+DcfManager::ResetSlotStats (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_slotStats.idleSlots = 0;
+  m_slotStats.busyPeriods = 0;
+  m_slotStats.successPeriods = 0;
+  m_slotStats.collisionPeriods = 0;
+  m_slotStats.otherPeriods = 0;
+  m_slotStats.ownTransmissions = 0;
+  m_slotStats.busyTime = Seconds (0.0);
+  std::fill (m_slotStats.idleRunHistogram.begin (), m_slotStats.idleRunHistogram.end (), 0);
+  std::fill (m_slotStats.busyLengthHistogram.begin (), m_slotStats.busyLengthHistogram.end (), 0);
+  if (m_slotStatsBusy)
+    {
+      Time now = Simulator::Now ();
+      if (m_slotStatsBusyEnd > now)
+        {
+          /* Still busy: the rest of the period belongs to this window */
+          m_slotStatsBusyStart = now;
+          m_slotStatsRxOk = false;
+          m_slotStatsRxError = false;
+          m_slotStatsTimeout = false;
+          m_slotStats.busyPeriods = 1;
+        }
+      else
+        {
+          /* Ended in the previous window: only its idle gap is kept */
+          m_slotStatsStale = true;
+        }
+    }
+}
+
 } //namespace ns3
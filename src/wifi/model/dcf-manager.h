@@ -36,6 +36,79 @@ class MacLow;
 class PhyListener;
 class LowDcfListener;
 
+/**
+ * \brief Contention state of a DcfState
+ *
+ * Used to warm-start a simulation with the state reached by a previous one.
+ * \see DcfState::GetSnapshot
+ */
+struct DcfStateSnapshot
+{
+  uint32_t cw;              //!< current contention window
+  uint32_t backoffSlots;    //!< backoff slots left
+  bool fillingTheBitmap;    //!< whether the schedule reduction bitmap is being built
+  std::vector<bool> bitmap; //!< schedule reduction bitmap
+};
+
+/**
+ * \brief CSMA/ECA state of a DcfManager
+ *
+ * Configuration (hysteresis, schedule reset, dynamic stickiness) is not
+ * part of the snapshot, it is set with DcfManager::SetEnvironmentForECA.
+ * \see DcfManager::GetEcaSnapshot
+ */
+struct DcfManagerEcaSnapshot
+{
+  uint32_t stickiness; //!< current stickiness
+};
+
+/**
+ * \brief CSMA/ECA state of a DcaTxop or EdcaTxopN
+ *
+ * \see EdcaTxopN::GetEcaSnapshot
+ */
+struct EcaTxopSnapshot
+{
+  DcfStateSnapshot dcf;             //!< contention state
+  uint32_t consecutiveSuccess;      //!< consecutive successful transmissions
+  uint32_t scheduleResetThreshold;  //!< successes needed before a schedule reduction
+  bool srBeingFilled;               //!< whether a schedule reduction bitmap is being built
+  uint32_t srIterations;            //!< schedule reduction iterations
+  uint32_t srReductionFactor;       //!< last schedule reduction factor
+  bool scheduleRecentlyReduced;     //!< whether the last cycle reduced the schedule
+  uint32_t srPreviousCw;            //!< CW before the last schedule reduction
+};
+
+/**
+ * \brief Occupancy of the medium as seen by a DcfManager
+ *
+ * A busy period starts when the medium goes busy (reception, own
+ * transmission or CCA busy) and lasts until it stays idle for SIFS
+ * plus a whole slot, so a frame and its ACK make one busy period even
+ * where SIFS is longer than a slot. Idle slots are the backoff slots
+ * between busy periods: they are counted from the end of the AIFS of
+ * the shortest AIFSN registered (plus EIFS - DIFS after a period with
+ * only erroneous receptions). Periods are classified when they end:
+ * success if a reception ended well, collision if only erroneous
+ * receptions ended or an own transmission timed out waiting for its
+ * ACK or CTS, other otherwise (e.g. energy detection only, frames
+ * that need no acknowledgment).
+ *
+ * \see DcfManager::GetSlotStats
+ */
+struct DcfSlotStats
+{
+  uint64_t idleSlots;                        //!< whole idle slots between busy periods
+  uint64_t busyPeriods;                      //!< busy periods started
+  uint64_t successPeriods;                   //!< ended busy periods with a good reception
+  uint64_t collisionPeriods;                 //!< ended busy periods with only bad receptions
+  uint64_t otherPeriods;                     //!< other ended busy periods
+  uint64_t ownTransmissions;                 //!< transmissions started by this station
+  Time busyTime;                             //!< duration of the ended busy periods
+  std::vector<uint64_t> idleRunHistogram;    //!< idle runs by length in slots, the last bin holds longer runs
+  std::vector<uint64_t> busyLengthHistogram; //!< ended busy periods by length in slots, the last bin holds longer ones
+};
+
 /**
  * \brief keep track of the state needed for a single DCF
  * function.
@@ -125,6 +198,45 @@ public:
    *          has not been granted already, false otherwise.
    */
   bool IsAccessRequested (void) const;
+  /**
+   * Start building a new CSMA/ECA schedule reduction bitmap. While
+   * the bitmap is being filled, DcfManager marks the slot of each
+   * backoff countdown of this DcfState that was busy.
+   *
+   * \param size the number of slots in the bitmap
+   */
+  void StartNewEcaBitmap (uint32_t size);
+  /**
+   * \returns the schedule reduction bitmap of this DcfState
+   */
+  std::vector<bool>* GetBitmap (void);
+  bool AreWeFillingTheBitmap (void) const;
+  void SetFillingTheBitmap (void);
+  void SetNotFillingTheBitmap (void);
+  /**
+   * \returns the number of idle slots counted down by the backoff
+   *          of this DcfState since it was created
+   */
+  uint64_t GetIdleSlots (void) const;
+  /**
+   * \returns the number of busy slots (transmissions of others)
+   *          observed while this DcfState was counting down
+   */
+  uint64_t GetBusySlots (void) const;
+  /**
+   * \returns the current contention state (CW, backoff slots left
+   *          and schedule reduction bitmap)
+   */
+  DcfStateSnapshot GetSnapshot (void) const;
+  /**
+   * \param snapshot a state previously returned by GetSnapshot
+   *
+   * Restore the CW, the backoff slots and the bitmap. The backoff restarts
+   * counting from now, so this should be called when the DcfState
+   * is about to contend (e.g., when traffic starts), and never while
+   * access is requested.
+   */
+  void RestoreSnapshot (const DcfStateSnapshot &snapshot);
 
 
 private:
@@ -149,6 +261,15 @@ private:
    * \param backoffUpdateBound
    */
   void UpdateBackoffSlotsNow (uint32_t nSlots, Time backoffUpdateBound);
+  /**
+   * Account for the slots seen by the backoff since the last update.
+   * Several busy notifications without an idle slot in between count
+   * as a single busy slot.
+   *
+   * \param idleSlots the idle slots counted down
+   * \param busy whether the medium became busy
+   */
+  void NotifySlotsObserved (uint32_t idleSlots, bool busy);
   /**
    * Notify that access request has been received.
    */
@@ -177,6 +298,10 @@ private:
    * Notify that the device has started to wake up
    */
   void NotifyWakeUp (void);
+  /**
+   * Notify that the CSMA/ECA environment of the DcfManager changed.
+   */
+  void NotifyEcaConfigChanged (void);
 
   /**
    * Called by DcfManager to notify a DcfState subclass
@@ -229,6 +354,14 @@ private:
   * is access is still needed.
   */
   virtual void DoNotifyWakeUp (void) = 0;
+  /**
+  * Called by DcfManager to notify a DcfState subclass that the
+  * CSMA/ECA environment changed.
+  *
+  * The subclass is expected to select the backoff policy matching
+  * the new environment. The default does nothing.
+  */
+  virtual void DoNotifyEcaConfigChanged (void);
 
   uint32_t m_aifsn;
   uint32_t m_backoffSlots;
@@ -240,6 +373,11 @@ private:
   uint32_t m_cwMax;
   uint32_t m_cw;
   bool m_accessRequested;
+  std::vector<bool> m_ecaBitmap;
+  bool m_areWeFillingTheBitmap;
+  uint64_t m_idleSlots;
+  uint64_t m_busySlots;
+  bool m_lastSlotBusy;
 };
 
 
@@ -425,8 +563,6 @@ public:
   bool GetEnvironmentForECA (void);
   bool GetHysteresisForECA (void);
   void UpdateTracedTxDuration (void);
-  void StartNewEcaBitmap (uint32_t size);
-  std::vector<bool>* GetBitmap (void);
   void UpdateEcaBitmap (DcfState *state);
   bool GetScheduleReset (void);
   bool isNextSlotBusy (void);
@@ -436,15 +572,69 @@ public:
   void ReduceStickiness (void);
   void ResetStickiness (void);
   void IncreaseStickiness (void);
+  /**
+   * Change the stickiness restored after every success. The current
+   * stickiness is capped to the new value.
+   *
+   * \param stickiness the new stickiness
+   */
+  void SetStickiness (uint32_t stickiness);
+  /**
+   * \return the stickiness given to SetEnvironmentForECA, whatever the
+   *         controller or the failures did to it since
+   */
+  uint32_t GetConfiguredStickiness (void) const;
+  /**
+   * The stickiness is shared by every DcfState of the manager, so only
+   * one of them may run the CSMA/ECA controller that adapts it.
+   *
+   * \param state the DcfState whose policy runs the controller
+   * \return false if another DcfState already runs it
+   */
+  bool AcquireEcaController (DcfState *state);
+  /**
+   * \param state a DcfState whose policy no longer runs the controller
+   */
+  void ReleaseEcaController (DcfState *state);
   bool UseDynamicStickiness (void);
-  bool AreWeFillingTheBitmap (void);
-  void SetFillingTheBitmap (void);
-  void SetNotFillingTheBitmap (void);
   void SetAmpduSimulation (void);
   bool GetAmpduSimulation (void);
+  DcfManagerEcaSnapshot GetEcaSnapshot (void) const;
+  void RestoreEcaSnapshot (const DcfManagerEcaSnapshot &snapshot);
+  /**
+   * Keep histograms of idle run and busy period lengths.
+   *
+   * \param bins number of bins of each histogram, 0 to disable them
+   */
+  void EnableSlotHistograms (uint32_t bins);
+  /**
+   * \returns the medium occupancy since the last ResetSlotStats. The
+   *          busy period in progress is not classified yet.
+   */
+  DcfSlotStats GetSlotStats (void) const;
+  /**
+   * Start a new measurement window. The histograms keep their size.
+   * A busy period still in progress is restarted in the new window;
+   * one that already ended but is not closed yet is left out of it.
+   */
+  void ResetSlotStats (void);
 
 
 private:
+  /**
+   * Account for the medium going busy in the slot statistics.
+   *
+   * \param duration how long it will be busy
+   */
+  void UpdateSlotStatsBusy (Time duration);
+  /**
+   * Classify and measure the busy period that just ended.
+   */
+  void CloseSlotStatsPeriod (void);
+  /**
+   * \return when the backoff slots that follow the open busy period start
+   */
+  Time GetSlotStatsIdleStart (void) const;
   /**
    * Update backoff slots for all DcfStates.
    */
@@ -583,14 +773,22 @@ private:
   bool m_isECA;
   bool m_hysteresis;
   bool m_scheduleReset;
-  std::vector<bool> m_ecaBitmap;
   bool m_isNextSlotBusy;
   uint32_t m_stickiness;
   uint32_t m_resetStickiness;
+  uint32_t m_configuredStickiness;
+  DcfState *m_ecaController; //!< DcfState running the controller, 0 if none
   bool m_dynamicStickiness;
-  bool m_areWeFillingTheBitmap;
   bool m_ecaFairShare;
 
+  DcfSlotStats m_slotStats;
+  bool m_slotStatsBusy;      //!< whether a busy period is open
+  Time m_slotStatsBusyStart; //!< start of the open busy period
+  Time m_slotStatsBusyEnd;   //!< expected end of the open busy period
+  bool m_slotStatsRxOk;      //!< a reception ended well in the open period
+  bool m_slotStatsRxError;   //!< a reception ended with errors in the open period
+  bool m_slotStatsTimeout;   //!< an own transmission waits for its ACK or CTS in the open period
+  bool m_slotStatsStale;     //!< the open period belongs to a window already reset
 
   TracedValue<uint64_t> m_lastTracedTxDuration;
 };
@@ -0,0 +1,718 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Luis Sanabria-Russo <luis.sanabria@upf.edu>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include "eca-policy.h"
+#include "dcf-manager.h"
+#include "random-stream.h"
+#include "hot-log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EcaPolicy");
+
+EcaPolicy::EcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                      const EcaTraces &traces, const EcaPolicyConfig &config)
+  : m_dcf (dcf),
+    m_manager (manager),
+    m_rng (rng),
+    m_traces (traces),
+    m_config (config)
+{
+  ResetState ();
+}
+
+EcaPolicy::~EcaPolicy ()
+{
+  if (m_config.controller)
+    {
+      m_manager->ReleaseEcaController (m_dcf);
+    }
+  m_dcf = 0;
+  m_manager = 0;
+  m_rng = 0;
+}
+
+void
+EcaPolicy::StartRandomBackoff (void)
+{
+  *m_traces.backoff = 0xFFFFFFFF;
+  *m_traces.backoff = m_rng->GetNext (0, m_dcf->GetCw ());
+  m_dcf->StartBackoffNow (*m_traces.backoff);
+}
+
+uint32_t
+EcaPolicy::GetDeterministicBackoff (void) const
+{
+  return ceil (m_dcf->GetCw () / 2) + 1;
+}
+
+void
+EcaPolicy::StartDeterministicBackoff (void)
+{
+  *m_traces.backoff = 0xFFFFFFFF;
+  *m_traces.backoff = GetDeterministicBackoff ();
+  m_dcf->StartBackoffNow (*m_traces.backoff);
+}
+
+const EcaPolicyConfig &
+EcaPolicy::GetConfig (void) const
+{
+  return m_config;
+}
+
+const EcaState &
+EcaPolicy::GetState (void) const
+{
+  return m_state;
+}
+
+void
+EcaPolicy::SetState (const EcaState &state)
+{
+  m_state = state;
+}
+
+void
+EcaPolicy::ResetState (void)
+{
+  m_state.consecutiveSuccess = 0;
+  m_state.scheduleResetThreshold = m_config.srThreshold;
+  m_state.srActivationThreshold = m_config.srActivationThreshold;
+  m_state.srBeingFilled = false;
+  m_state.srIterations = 0;
+  m_state.srReductionFactor = 1;
+  m_state.scheduleRecentlyReduced = false;
+  m_state.srPreviousCw = 0;
+  m_state.quietSuccesses = 0;
+  m_state.protection = true;
+  RestartControllerWindow ();
+}
+
+bool
+EcaPolicy::IsProtectionEnabled (void) const
+{
+  return m_state.protection;
+}
+
+void
+EcaPolicy::UpdateProtection (bool failed)
+{
+  if (failed)
+    {
+      m_state.quietSuccesses = 0;
+      if (!m_state.protection)
+        {
+          MY_DEBUG ("Failure on the schedule, RTS/CTS back on");
+          m_state.protection = true;
+          *m_traces.rtsEnabled = true;
+        }
+      return;
+    }
+  m_state.quietSuccesses++;
+  if (m_state.protection && m_state.quietSuccesses >= m_config.rtsSuppressAfter)
+    {
+      MY_DEBUG ("Schedule collision-free for " << m_state.quietSuccesses << " successes, RTS/CTS off");
+      m_state.protection = false;
+      *m_traces.rtsEnabled = false;
+    }
+}
+
+void
+EcaPolicy::SetScheduleResetActivationThreshold (uint32_t threshold)
+{
+  m_state.srActivationThreshold = threshold;
+}
+
+void
+EcaPolicy::SaveSnapshot (EcaTxopSnapshot *snapshot) const
+{
+  snapshot->consecutiveSuccess = m_state.consecutiveSuccess;
+  snapshot->scheduleResetThreshold = m_state.scheduleResetThreshold;
+  snapshot->srBeingFilled = m_state.srBeingFilled;
+  snapshot->srIterations = m_state.srIterations;
+  snapshot->srReductionFactor = m_state.srReductionFactor;
+  snapshot->scheduleRecentlyReduced = m_state.scheduleRecentlyReduced;
+  snapshot->srPreviousCw = m_state.srPreviousCw;
+}
+
+void
+EcaPolicy::RestoreSnapshot (const EcaTxopSnapshot &snapshot)
+{
+  m_state.consecutiveSuccess = snapshot.consecutiveSuccess;
+  m_state.scheduleResetThreshold = snapshot.scheduleResetThreshold;
+  m_state.srBeingFilled = snapshot.srBeingFilled;
+  m_state.srIterations = snapshot.srIterations;
+  m_state.srReductionFactor = snapshot.srReductionFactor;
+  m_state.scheduleRecentlyReduced = snapshot.scheduleRecentlyReduced;
+  m_state.srPreviousCw = snapshot.srPreviousCw;
+}
+
+void
+EcaPolicy::ResetSrMetrics (void)
+{
+  m_state.srBeingFilled = false;
+  m_dcf->SetNotFillingTheBitmap ();
+  if (m_state.scheduleRecentlyReduced == true)
+    {
+      MY_DEBUG ("Resetting the chances made by Schedule Reset. Cw back to: " << m_state.srPreviousCw);
+      m_dcf->SetCw (m_state.srPreviousCw);
+    }
+  m_state.scheduleRecentlyReduced = false;
+}
+
+void
+EcaPolicy::RestartControllerWindow (void)
+{
+  m_state.ctrlTransmissions = 0;
+  m_state.ctrlFailures = 0;
+  m_state.ctrlIdleSlots = m_dcf->GetIdleSlots ();
+  m_state.ctrlBusySlots = m_dcf->GetBusySlots ();
+  /* Not the current stickiness, which failures may have lowered */
+  m_state.ctrlStickiness = std::min (m_manager->GetConfiguredStickiness (), m_config.maxStickiness);
+}
+
+void
+EcaPolicy::ObserveTransmission (bool failed)
+{
+  m_state.ctrlTransmissions++;
+  if (failed)
+    {
+      m_state.ctrlFailures++;
+    }
+  if (m_state.ctrlTransmissions < m_config.controllerWindow)
+    {
+      return;
+    }
+
+  /* Own transmissions are busy slots too */
+  uint64_t idle = m_dcf->GetIdleSlots () - m_state.ctrlIdleSlots;
+  uint64_t busy = m_dcf->GetBusySlots () - m_state.ctrlBusySlots + m_state.ctrlTransmissions;
+  double empty = (double) idle / (idle + busy);
+  double collisions = (double) m_state.ctrlFailures / m_state.ctrlTransmissions;
+  *m_traces.emptySlots = empty;
+  *m_traces.collisionRate = collisions;
+  MY_DEBUG ("Controller: empty slots " << empty << ", failures " << collisions);
+
+  if (collisions > m_config.targetCollisions)
+    {
+      if (m_state.ctrlStickiness > 0)
+        {
+          m_state.ctrlStickiness--;
+        }
+    }
+  else
+    {
+      if (m_state.ctrlStickiness < m_config.maxStickiness)
+        {
+          m_state.ctrlStickiness++;
+        }
+      if (empty > m_config.targetEmptySlots && m_dcf->GetCw () > m_dcf->GetCwMin ())
+        {
+          uint32_t cw = std::max ((m_dcf->GetCw () + 1) / 2 - 1, m_dcf->GetCwMin ());
+          MY_DEBUG ("Controller: stepping Cw down from " << m_dcf->GetCw () << " to " << cw);
+          m_dcf->SetCw (cw);
+          (*m_traces.cwStepDowns)++;
+          /* The bitmap being filled belongs to the old schedule */
+          m_state.scheduleRecentlyReduced = false;
+          m_state.srBeingFilled = false;
+          m_dcf->SetNotFillingTheBitmap ();
+        }
+    }
+  m_manager->SetStickiness (m_state.ctrlStickiness);
+  *m_traces.stickiness = m_state.ctrlStickiness;
+
+  m_state.ctrlTransmissions = 0;
+  m_state.ctrlFailures = 0;
+  m_state.ctrlIdleSlots = m_dcf->GetIdleSlots ();
+  m_state.ctrlBusySlots = m_dcf->GetBusySlots ();
+}
+
+
+/**
+ * Standard DCF: random backoffs, CW reset after success.
+ */
+class DcfPolicy : public EcaPolicy
+{
+public:
+  DcfPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+             const EcaTraces &traces, const EcaPolicyConfig &config)
+    : EcaPolicy (dcf, manager, rng, traces, config)
+  {
+  }
+
+  virtual void NotifySuccess (void)
+  {
+    m_state.consecutiveSuccess++;
+    m_manager->ResetStickiness ();
+    m_dcf->ResetCw ();
+    StartRandomBackoff ();
+  }
+  virtual void NotifyTxNoAck (void)
+  {
+    m_dcf->ResetCw ();
+    StartRandomBackoff ();
+  }
+  virtual bool NotifyFailure (void)
+  {
+    m_state.consecutiveSuccess = 0;
+    m_dcf->UpdateFailedCw ();
+    StartRandomBackoff ();
+    return true;
+  }
+  virtual bool NotifyCollision (void)
+  {
+    m_dcf->ResetCw ();
+    StartRandomBackoff ();
+    return true;
+  }
+};
+
+
+/**
+ * CSMA/ECA: deterministic backoff after success, random after failure.
+ */
+template <bool Hysteresis, enum EcaScheduleReduction ScheduleReduction, bool DynamicStickiness,
+          bool Controller, bool RtsSuppression>
+class EcaPolicyImpl : public EcaPolicy
+{
+public:
+  EcaPolicyImpl (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                 const EcaTraces &traces, const EcaPolicyConfig &config)
+    : EcaPolicy (dcf, manager, rng, traces, config)
+  {
+  }
+
+  virtual void NotifySuccess (void)
+  {
+    m_state.consecutiveSuccess++;
+    if (RtsSuppression)
+      {
+        UpdateProtection (false);
+      }
+    if (Controller)
+      {
+        ObserveTransmission (false);
+      }
+    m_manager->ResetStickiness ();
+    if (!Hysteresis)
+      {
+        m_dcf->ResetCw ();
+      }
+    if (ScheduleReduction != ECA_SR_NONE)
+      {
+        UpdateScheduleReduction ();
+      }
+    StartDeterministicBackoff ();
+  }
+  virtual void NotifyTxNoAck (void)
+  {
+    if (!Hysteresis)
+      {
+        m_dcf->ResetCw ();
+      }
+    StartDeterministicBackoff ();
+  }
+  virtual bool NotifyFailure (void)
+  {
+    if (RtsSuppression)
+      {
+        UpdateProtection (true);
+      }
+    if (Controller)
+      {
+        ObserveTransmission (true);
+      }
+    if (m_manager->GetStickiness () > 0)
+      {
+        MY_DEBUG ("Reducing stickiness from: " << m_manager->GetStickiness ());
+        m_manager->ReduceStickiness ();
+        StartDeterministicBackoff ();
+        return false;
+      }
+    m_state.consecutiveSuccess = 0;
+    if (ScheduleReduction != ECA_SR_NONE)
+      {
+        ResetSrMetrics ();
+      }
+    m_dcf->UpdateFailedCw ();
+    StartRandomBackoff ();
+    return true;
+  }
+  virtual bool NotifyCollision (void)
+  {
+    if (RtsSuppression)
+      {
+        UpdateProtection (true);
+      }
+    if (m_manager->GetStickiness () > 0)
+      {
+        m_manager->ReduceStickiness ();
+        StartDeterministicBackoff ();
+        return false;
+      }
+    if (ScheduleReduction != ECA_SR_NONE)
+      {
+        ResetSrMetrics ();
+      }
+    if (!Hysteresis)
+      {
+        m_dcf->ResetCw ();
+      }
+    StartRandomBackoff ();
+    return true;
+  }
+
+private:
+  /**
+   * After a success: start filling a bitmap, or check the one just
+   * filled and reduce the schedule if possible.
+   */
+  void UpdateScheduleReduction (void)
+  {
+    /* A success after a reduction confirms it */
+    m_state.scheduleRecentlyReduced = false;
+
+    if (m_state.srActivationThreshold == 0)
+      {
+        m_state.srActivationThreshold = (m_dcf->GetCwMax () + 1) / (m_dcf->GetCw () + 1);
+      }
+    if (m_state.consecutiveSuccess < m_state.srActivationThreshold)
+      {
+        return;
+      }
+    if (m_config.srWindow > 0)
+      {
+        UpdateSlidingScheduleReduction ();
+        return;
+      }
+
+    if (!m_state.srBeingFilled)
+      {
+        HOT_LOG_DEBUG ("Starting to fill the bitmap");
+        if (m_config.conservative)
+          {
+            m_state.scheduleResetThreshold = ((m_dcf->GetCwMax () + 1) / 2) / GetDeterministicBackoff ();
+          }
+        else
+          {
+            m_state.scheduleResetThreshold = m_config.srThreshold;
+          }
+        uint32_t size = ((m_dcf->GetCw () + 1) / 2) + 1;
+        m_dcf->StartNewEcaBitmap (size);
+        m_state.srBeingFilled = true;
+        m_dcf->SetFillingTheBitmap ();
+        m_state.srIterations = m_state.consecutiveSuccess;
+      }
+    else if ((m_state.consecutiveSuccess - m_state.srIterations) >= m_state.scheduleResetThreshold)
+      {
+        HOT_LOG_DEBUG ("Checking bitmap for Schedule Reset");
+        if (CanWeReduceTheSchedule (m_dcf->GetBitmap ()))
+          {
+            ModifyCwAccordingToScheduleReduction ();
+          }
+        else
+          {
+            HOT_LOG_DEBUG ("We cannot reduce the schedule");
+          }
+        m_state.srBeingFilled = false;
+        m_dcf->SetNotFillingTheBitmap ();
+        m_state.consecutiveSuccess = 0;
+        m_state.srIterations = 0;
+      }
+  }
+
+  /**
+   * Sliding window variant: every success closes a cycle, which
+   * replaces the oldest of the last srWindow cycles. Once the window
+   * is full, a slot counts as busy if it was busy in any cycle of the
+   * window, and the schedule is checked after every success.
+   */
+  void UpdateSlidingScheduleReduction (void)
+  {
+    uint32_t size = ((m_dcf->GetCw () + 1) / 2) + 1;
+    std::vector<bool> *bitmap = m_dcf->GetBitmap ();
+    if (!m_state.srBeingFilled || bitmap->size () != size || m_busyCycles.size () != size)
+      {
+        /* First cycle, the CW changed, or this policy replaced the one that
+         * kept the history (srBeingFilled is carried in EcaState, the history
+         * is not): the history no longer applies */
+        HOT_LOG_DEBUG ("Starting a new slot history of size " << size);
+        ClearSlotHistory (size);
+        m_dcf->StartNewEcaBitmap (size);
+        m_state.srBeingFilled = true;
+        m_dcf->SetFillingTheBitmap ();
+        return;
+      }
+
+    m_history.push_back (*bitmap);
+    for (uint32_t i = 0; i < size; i++)
+      {
+        m_busyCycles[i] += bitmap->at (i);
+      }
+    if (m_history.size () > m_config.srWindow)
+      {
+        const std::vector<bool> &oldest = m_history.front ();
+        for (uint32_t i = 0; i < size; i++)
+          {
+            m_busyCycles[i] -= oldest[i];
+          }
+        m_history.pop_front ();
+      }
+    m_dcf->StartNewEcaBitmap (size);
+
+    if (m_history.size () < m_config.srWindow)
+      {
+        return;
+      }
+    for (uint32_t i = 0; i < size; i++)
+      {
+        m_windowBitmap[i] = (m_busyCycles[i] > 0);
+      }
+    if (CanWeReduceTheSchedule (&m_windowBitmap))
+      {
+        ModifyCwAccordingToScheduleReduction ();
+        size = ((m_dcf->GetCw () + 1) / 2) + 1;
+        ClearSlotHistory (size);
+        m_dcf->StartNewEcaBitmap (size);
+        m_state.consecutiveSuccess = 0;
+      }
+  }
+
+  void ClearSlotHistory (uint32_t size)
+  {
+    m_history.clear ();
+    m_busyCycles.assign (size, 0);
+    m_windowBitmap.assign (size, false);
+  }
+
+  bool CanWeReduceTheSchedule (std::vector<bool> *bitmap)
+  {
+    bool canI = false;
+    HOT_LOG_DEBUG ("Checking a bitmap of size " << bitmap->size ());
+
+    /* Updating the traced value */
+    *m_traces.bitmap = (std::vector<bool>*) 0;
+    *m_traces.bitmap = bitmap;
+
+    uint32_t currentSize = bitmap->size ();
+    if (ScheduleReduction == ECA_SR_HALVING)
+      {
+        uint32_t midpoint = (currentSize - 1) / 2;
+        if (bitmap->at (midpoint) == 0)
+          {
+            HOT_LOG_DEBUG ("A schedule halving is possible. Size: " << currentSize);
+            canI = true;
+            m_state.srReductionFactor = 2;
+          }
+      }
+    else
+      {
+        uint32_t maxStage = log2 ((m_dcf->GetCw () + 1) / (m_dcf->GetCwMin () + 1));
+        if (maxStage > 1)
+          {
+            for (uint32_t i = 0; i <= maxStage; i++)
+              {
+                uint32_t position = pow (2, i) * std::ceil ((m_dcf->GetCwMin () + 1) / 2);
+                NS_ASSERT (position < currentSize);
+                if (bitmap->at (position) == 0)
+                  {
+                    HOT_LOG_DEBUG ("A schedule reset is possible. Position: " << position);
+                    canI = true;
+                    m_state.srReductionFactor = (m_dcf->GetCw () + 1) / (pow (2, i) * (m_dcf->GetCwMin () + 1));
+                    break;
+                  }
+              }
+          }
+        else if (maxStage == 1)
+          {
+            canI = true;
+            m_state.srReductionFactor = 1;
+          }
+      }
+
+    /* Updating traced values */
+    (*m_traces.srAttempts)++;
+    if (canI == true)
+      {
+        (*m_traces.srReductions)++;
+      }
+    else
+      {
+        (*m_traces.srFailed)++;
+      }
+    return canI;
+  }
+
+  void ModifyCwAccordingToScheduleReduction (void)
+  {
+    m_state.srPreviousCw = m_dcf->GetCw ();
+    uint32_t factor = m_state.srReductionFactor;
+    NS_ASSERT (factor > 0);
+
+    uint32_t reduced = std::max (((m_dcf->GetCw () + 1) / factor) - 1, m_dcf->GetCwMin ());
+    NS_ASSERT (reduced % 2 != 0);
+    m_dcf->SetCw (reduced);
+
+    HOT_LOG_DEBUG ("Schedule Reset modified Cw from: " << m_state.srPreviousCw << " to: " << m_dcf->GetCw ());
+
+    if (DynamicStickiness)
+      {
+        m_manager->IncreaseStickiness ();
+      }
+    m_state.scheduleRecentlyReduced = true;
+  }
+
+  std::deque<std::vector<bool> > m_history; //!< bitmaps of the last srWindow cycles
+  std::vector<uint32_t> m_busyCycles;        //!< cycles of the window in which each slot was busy
+  std::vector<bool> m_windowBitmap;          //!< busy slots over the whole window
+};
+
+
+template <bool Hysteresis, enum EcaScheduleReduction ScheduleReduction, bool DynamicStickiness, bool Controller>
+static EcaPolicy *
+CreateEcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                 const EcaTraces &traces, const EcaPolicyConfig &config)
+{
+  if (config.rtsSuppressAfter > 0)
+    {
+      return new EcaPolicyImpl<Hysteresis, ScheduleReduction, DynamicStickiness, Controller, true>
+        (dcf, manager, rng, traces, config);
+    }
+  return new EcaPolicyImpl<Hysteresis, ScheduleReduction, DynamicStickiness, Controller, false>
+    (dcf, manager, rng, traces, config);
+}
+
+template <bool Hysteresis, enum EcaScheduleReduction ScheduleReduction, bool DynamicStickiness>
+static EcaPolicy *
+CreateEcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                 const EcaTraces &traces, const EcaPolicyConfig &config)
+{
+  if (config.controller)
+    {
+      return CreateEcaPolicy<Hysteresis, ScheduleReduction, DynamicStickiness, true> (dcf, manager, rng, traces, config);
+    }
+  return CreateEcaPolicy<Hysteresis, ScheduleReduction, DynamicStickiness, false> (dcf, manager, rng, traces, config);
+}
+
+template <bool Hysteresis, enum EcaScheduleReduction ScheduleReduction>
+static EcaPolicy *
+CreateEcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                 const EcaTraces &traces, const EcaPolicyConfig &config)
+{
+  if (config.dynamicStickiness)
+    {
+      return CreateEcaPolicy<Hysteresis, ScheduleReduction, true> (dcf, manager, rng, traces, config);
+    }
+  return CreateEcaPolicy<Hysteresis, ScheduleReduction, false> (dcf, manager, rng, traces, config);
+}
+
+template <bool Hysteresis>
+static EcaPolicy *
+CreateEcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                 const EcaTraces &traces, const EcaPolicyConfig &config)
+{
+  switch (config.scheduleReduction)
+    {
+    case ECA_SR_HALVING:
+      return CreateEcaPolicy<Hysteresis, ECA_SR_HALVING> (dcf, manager, rng, traces, config);
+    case ECA_SR_RESET:
+      return CreateEcaPolicy<Hysteresis, ECA_SR_RESET> (dcf, manager, rng, traces, config);
+    default:
+      return CreateEcaPolicy<Hysteresis, ECA_SR_NONE> (dcf, manager, rng, traces, config);
+    }
+}
+
+EcaPolicy *
+EcaPolicy::Create (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                   const EcaTraces &traces, const EcaPolicyConfig &config)
+{
+  NS_LOG_FUNCTION (dcf << config.eca << config.hysteresis << config.scheduleReduction << config.dynamicStickiness);
+  if (!config.eca)
+    {
+      return new DcfPolicy (dcf, manager, rng, traces, config);
+    }
+  if (config.hysteresis)
+    {
+      return CreateEcaPolicy<true> (dcf, manager, rng, traces, config);
+    }
+  return CreateEcaPolicy<false> (dcf, manager, rng, traces, config);
+}
+
+EcaPolicy *
+EcaPolicy::Select (EcaPolicy *current, DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                   const EcaTraces &traces, const EcaPolicyConfig &settings)
+{
+  EcaPolicyConfig config = settings;
+  config.eca = manager->GetEnvironmentForECA ();
+  config.hysteresis = manager->GetHysteresisForECA ();
+  if (!manager->GetScheduleReset ())
+    {
+      config.scheduleReduction = ECA_SR_NONE;
+    }
+  config.dynamicStickiness = manager->UseDynamicStickiness ();
+
+  EcaPolicy *policy = Create (dcf, manager, rng, traces, config);
+  if (current != 0)
+    {
+      policy->SetState (current->GetState ());
+      if (config.controller && !current->GetConfig ().controller)
+        {
+          /* The window of a controller that was off is stale */
+          policy->RestartControllerWindow ();
+        }
+      delete current;
+    }
+  NS_ABORT_MSG_IF (config.controller && !manager->AcquireEcaController (dcf),
+                   "Only one CSMA/ECA controller per DcfManager: they would share its stickiness");
+  if (config.rtsSuppressAfter == 0 && !policy->m_state.protection)
+    {
+      policy->m_state.protection = true;
+      *traces.rtsEnabled = true;
+    }
+  return policy;
+}
+
+EcaPolicyConfig
+EcaPolicy::GetDefaultConfig (void)
+{
+  EcaPolicyConfig config;
+  config.eca = false;
+  config.hysteresis = false;
+  config.scheduleReduction = ECA_SR_HALVING;
+  config.dynamicStickiness = false;
+  config.conservative = false;
+  config.srThreshold = 1;
+  config.srActivationThreshold = 0;
+  config.srWindow = 0;
+  config.controller = false;
+  config.targetEmptySlots = 0.5;
+  config.targetCollisions = 0.05;
+  config.controllerWindow = 100;
+  config.maxStickiness = 0;
+  config.rtsSuppressAfter = 0;
+  return config;
+}
+
+} //namespace ns3
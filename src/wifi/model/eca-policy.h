@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Luis Sanabria-Russo <luis.sanabria@upf.edu>
+ */
+
+#ifndef ECA_POLICY_H
+#define ECA_POLICY_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+class DcfState;
+class DcfManager;
+class RandomStream;
+struct EcaTxopSnapshot;
+
+/**
+ * How CSMA/ECA shortens a schedule once the bitmap shows it is possible.
+ */
+enum EcaScheduleReduction
+{
+  ECA_SR_NONE,    //!< no schedule reduction
+  ECA_SR_HALVING, //!< halve the CW (Schedule Halving)
+  ECA_SR_RESET    //!< jump to the smallest free stage (Schedule Reset)
+};
+
+/**
+ * \brief Variant of CSMA/ECA run by a DcaTxop or EdcaTxopN
+ *
+ * The transmitters keep their settings in one of these. EcaPolicy::Select
+ * takes eca, hysteresis and dynamicStickiness from the DcfManager
+ * environment, and keeps scheduleReduction only if the DcfManager enables
+ * schedule reduction.
+ */
+struct EcaPolicyConfig
+{
+  bool eca;                                    //!< deterministic backoff after success
+  bool hysteresis;                             //!< keep the CW after success
+  enum EcaScheduleReduction scheduleReduction; //!< schedule reduction variant
+  bool dynamicStickiness;                      //!< increase stickiness after a reduction
+  bool conservative;                           //!< threshold between bitmap checks grows with CwMax
+  uint32_t srThreshold;                        //!< successes between bitmap checks when not conservative
+  uint32_t srActivationThreshold;              //!< initial successes before filling a bitmap, 0 to derive it from the CW
+  uint32_t srWindow;                           //!< cycles of slot history checked after every success, 0 for fill/check rounds
+  bool controller;                             //!< adapt stickiness and CW to the observed slots
+  double targetEmptySlots;                     //!< empty slot fraction above which the CW steps down
+  double targetCollisions;                     //!< failure rate above which stickiness is lowered
+  uint32_t controllerWindow;                   //!< own transmissions per controller decision
+  uint32_t maxStickiness;                      //!< upper bound of the adapted stickiness
+  uint32_t rtsSuppressAfter;                   //!< collision-free successes before RTS/CTS is switched off, 0 to leave it to the station manager
+};
+
+/**
+ * \brief CSMA/ECA bookkeeping of a transmitter, kept across policy changes
+ */
+struct EcaState
+{
+  uint32_t consecutiveSuccess;     //!< consecutive successful transmissions
+  uint32_t scheduleResetThreshold; //!< successes needed before checking the bitmap
+  uint32_t srActivationThreshold;  //!< successes needed before filling a bitmap
+  bool srBeingFilled;              //!< whether a bitmap is being built
+  uint32_t srIterations;           //!< consecutive successes when the bitmap was started
+  uint32_t srReductionFactor;      //!< last schedule reduction factor
+  bool scheduleRecentlyReduced;    //!< whether the last cycle reduced the schedule
+  uint32_t srPreviousCw;           //!< CW before the last schedule reduction
+  uint32_t quietSuccesses;         //!< successes since the last failure or collision
+  bool protection;                 //!< whether RTS/CTS protection is on
+  uint32_t ctrlTransmissions;      //!< transmissions in the current controller window
+  uint32_t ctrlFailures;           //!< failures in the current controller window
+  uint64_t ctrlIdleSlots;          //!< idle slots of the DcfState when the window started
+  uint64_t ctrlBusySlots;          //!< busy slots of the DcfState when the window started
+  uint32_t ctrlStickiness;         //!< stickiness chosen by the controller
+};
+
+/**
+ * \brief Trace sources of the transmitter updated by its policy
+ */
+struct EcaTraces
+{
+  TracedValue<uint32_t> *backoff;           //!< assigned backoff
+  TracedValue<std::vector<bool> *> *bitmap; //!< last bitmap checked
+  TracedValue<uint32_t> *srAttempts;        //!< schedule reduction attempts
+  TracedValue<uint32_t> *srReductions;      //!< successful schedule reductions
+  TracedValue<uint32_t> *srFailed;          //!< failed schedule reductions
+  TracedValue<double> *emptySlots;          //!< empty slot fraction of the last controller window
+  TracedValue<double> *collisionRate;       //!< failure rate of the last controller window
+  TracedValue<uint32_t> *stickiness;        //!< stickiness chosen by the controller
+  TracedValue<uint32_t> *cwStepDowns;       //!< CW stages dropped by the controller
+  TracedValue<bool> *rtsEnabled;            //!< whether RTS/CTS protection is on
+};
+
+/**
+ * \brief CSMA/ECA backoff policy shared by DcaTxop and EdcaTxopN
+ * \ingroup wifi
+ *
+ * Decides the CW and backoff after each transmission outcome. Every
+ * variant (plain DCF, hysteresis, schedule halving/reset, dynamic
+ * stickiness, controller, RTS/CTS suppression) is a separate
+ * instantiation selected by EcaPolicy::Create, so the outcome handlers
+ * do not test configuration flags.
+ *
+ * The transmitter keeps control of its queues and of when to restart
+ * access; the policy only updates its DcfState (CW, backoff and
+ * schedule reduction bitmap), the DcfManager stickiness, and the
+ * backoff related traces.
+ */
+class EcaPolicy
+{
+public:
+  /**
+   * \param dcf the DcfState of the transmitter
+   * \param manager the DcfManager the DcfState is registered with
+   * \param rng random stream for random backoffs
+   * \param traces trace sources of the transmitter
+   * \param config the CSMA/ECA variant
+   *
+   * \return a new policy, to be deleted by the caller
+   */
+  static EcaPolicy * Create (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                             const EcaTraces &traces, const EcaPolicyConfig &config);
+  /**
+   * Replace the policy of a transmitter after its settings or the
+   * DcfManager environment changed. The state of the current policy is
+   * carried over.
+   *
+   * \param current the policy to replace, deleted here, or 0
+   * \param dcf the DcfState of the transmitter
+   * \param manager the DcfManager the DcfState is registered with
+   * \param rng random stream for random backoffs
+   * \param traces trace sources of the transmitter
+   * \param settings the settings of the transmitter
+   *
+   * \return the new policy, to be deleted by the caller
+   */
+  static EcaPolicy * Select (EcaPolicy *current, DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+                             const EcaTraces &traces, const EcaPolicyConfig &settings);
+  /**
+   * \return the settings of a transmitter nobody configured: plain DCF,
+   * schedule halving if the DcfManager enables schedule reduction
+   */
+  static EcaPolicyConfig GetDefaultConfig (void);
+  /**
+   * \param txop a DcaTxop or EdcaTxopN, which must be friends of EcaPolicy
+   *
+   * \return the trace sources of \p txop updated by its policy
+   */
+  template <typename Txop>
+  static EcaTraces GetTraces (Txop *txop);
+
+  virtual ~EcaPolicy ();
+
+  /**
+   * The transmission was acknowledged (or was the last fragment of it).
+   * Starts the next backoff.
+   */
+  virtual void NotifySuccess (void) = 0;
+  /**
+   * A transmission that did not require an ACK ended. Starts the next backoff.
+   */
+  virtual void NotifyTxNoAck (void) = 0;
+  /**
+   * The ACK was missed and the packet will be retransmitted.
+   * Starts the next backoff.
+   *
+   * \return true if this counts as a failure, false if stickiness absorbed it
+   */
+  virtual bool NotifyFailure (void) = 0;
+  /**
+   * The medium was busy when access was requested, or an internal
+   * collision occurred. Starts the next backoff.
+   *
+   * \return true if this counts as a collision, false if stickiness absorbed it
+   */
+  virtual bool NotifyCollision (void) = 0;
+
+  /**
+   * Start a random backoff in [0, CW].
+   */
+  void StartRandomBackoff (void);
+  /**
+   * \return the deterministic backoff CSMA/ECA uses for the current CW
+   */
+  uint32_t GetDeterministicBackoff (void) const;
+
+  const EcaPolicyConfig & GetConfig (void) const;
+  const EcaState & GetState (void) const;
+  void SetState (const EcaState &state);
+  /**
+   * Forget all bookkeeping, as on a fresh transmitter.
+   */
+  void ResetState (void);
+  void SetScheduleResetActivationThreshold (uint32_t threshold);
+  /**
+   * \param snapshot where to write the schedule reduction state; the
+   * contention state is left to the caller
+   */
+  void SaveSnapshot (EcaTxopSnapshot *snapshot) const;
+  /**
+   * \param snapshot schedule reduction state written by SaveSnapshot
+   */
+  void RestoreSnapshot (const EcaTxopSnapshot &snapshot);
+  /**
+   * With rtsSuppressAfter set, RTS/CTS protects the transmissions made
+   * after a random backoff, or on a schedule kept by stickiness after a
+   * failure. It is dropped once the deterministic schedule has gone
+   * rtsSuppressAfter successes without failures. Without it, the
+   * protection is always left to the station manager.
+   *
+   * \return whether the next transmission may be protected by RTS/CTS
+   */
+  bool IsProtectionEnabled (void) const;
+
+
+protected:
+  EcaPolicy (DcfState *dcf, Ptr<DcfManager> manager, RandomStream *rng,
+             const EcaTraces &traces, const EcaPolicyConfig &config);
+
+  void StartDeterministicBackoff (void);
+  /**
+   * Undo a schedule reduction that led to a failure, and stop filling the bitmap.
+   */
+  void ResetSrMetrics (void);
+  /**
+   * Controller: every controllerWindow transmissions, estimate the
+   * empty slot fraction and the failure rate. Lower the stickiness
+   * when failures are above target, otherwise raise it and, if too
+   * many slots are empty, drop the CW one stage so that the cycle
+   * follows the number of active contenders.
+   *
+   * \param failed whether the transmission failed
+   */
+  void ObserveTransmission (bool failed);
+  /**
+   * Start a new controller window from the current slot counts and
+   * stickiness.
+   */
+  void RestartControllerWindow (void);
+  /**
+   * Count a success towards switching RTS/CTS off, or switch it back on
+   * after a failure or collision, absorbed by stickiness or not.
+   *
+   * \param failed whether the transmission failed
+   */
+  void UpdateProtection (bool failed);
+
+  DcfState *m_dcf;
+  Ptr<DcfManager> m_manager;
+  RandomStream *m_rng;
+  EcaTraces m_traces;
+  EcaPolicyConfig m_config;
+  EcaState m_state;
+};
+
+template <typename Txop>
+EcaTraces
+EcaPolicy::GetTraces (Txop *txop)
+{
+  EcaTraces traces;
+  traces.backoff = &txop->m_boCounter;
+  traces.bitmap = &txop->m_ecaBitmap;
+  traces.srAttempts = &txop->m_scheduleReductionAttempts;
+  traces.srReductions = &txop->m_scheduleReductions;
+  traces.srFailed = &txop->m_scheduleReductionFailed;
+  traces.emptySlots = &txop->m_ctrlEmptySlots;
+  traces.collisionRate = &txop->m_ctrlCollisionRate;
+  traces.stickiness = &txop->m_ctrlStickiness;
+  traces.cwStepDowns = &txop->m_ctrlCwStepDowns;
+  traces.rtsEnabled = &txop->m_ecaRtsEnabled;
+  return traces;
+}
+
+} //namespace ns3
+
+#endif /* ECA_POLICY_H */
@@ -30,15 +30,15 @@
 #include "wifi-mac-trailer.h"
 #include "wifi-mac.h"
 #include "random-stream.h"
+#include "eca-policy.h"
 #include "wifi-mac-queue.h"
 #include "msdu-aggregator.h"
 #include "mgt-headers.h"
 #include "qos-blocked-destinations.h"
+#include "hot-log.h"
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT if (m_low != 0) { std::clog << "[mac=" << m_low->GetAddress () << "] "; }
-#define MY_DEBUG(x) \
-  NS_LOG_DEBUG (Simulator::Now () << " " << this << " " << x)
 
 namespace ns3 {
 
@@ -51,10 +51,6 @@ public:
     : m_txop (txop)
   {
   }
-    // virtual void DoDeterministicBackoff (uint32_t cw)
-    // {
-    //   m_txop->StartBackoffNow (m_txop->deterministicBackoff (cw));
-    // }
 
 private:
   virtual void DoNotifyAccessGranted (void)
@@ -81,6 +77,10 @@ private:
   {
     m_txop->NotifyWakeUp ();
   }
+  virtual void DoNotifyEcaConfigChanged (void)
+  {
+    m_txop->SelectEcaPolicy ();
+  }
 
   EdcaTxopN *m_txop;
 };
@@ -217,6 +217,18 @@ public:
   {
     return m_txop->MapDestAddressForAggregation (hdr);
   }
+  virtual uint16_t GetFairShareAmpduLimit (void)
+  {
+    return m_txop->GetFairShareAmpduLimit ();
+  }
+  virtual uint16_t GetDestinationAmpduLimit (Mac48Address dest)
+  {
+    return m_txop->GetDestinationAmpduLimit (dest);
+  }
+  virtual void CompleteAmpduAggregation (Mac48Address dest, uint32_t nMpdus)
+  {
+    m_txop->CompleteAmpduAggregation (dest, nMpdus);
+  }
 
 private:
   EdcaTxopN *m_txop;
@@ -278,6 +290,21 @@ EdcaTxopN::GetTypeId (void)
     .AddTraceSource ("SrReductionFailed", "Times does not comply with SR criteria",
                     MakeTraceSourceAccessor (&EdcaTxopN::m_scheduleReductionFailed),
                     "ns3::Traced::Value:Uint32Callback")
+    .AddTraceSource ("EcaEmptySlots", "Empty slot fraction seen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&EdcaTxopN::m_ctrlEmptySlots),
+                    "ns3::Traced::Value::DoubleCallback")
+    .AddTraceSource ("EcaCollisionRate", "Failure rate seen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&EdcaTxopN::m_ctrlCollisionRate),
+                    "ns3::Traced::Value::DoubleCallback")
+    .AddTraceSource ("EcaStickiness", "Stickiness chosen by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&EdcaTxopN::m_ctrlStickiness),
+                    "ns3::Traced::Value::Uint32Callback")
+    .AddTraceSource ("EcaCwStepDowns", "CW stages dropped by the CSMA/ECA controller",
+                    MakeTraceSourceAccessor (&EdcaTxopN::m_ctrlCwStepDowns),
+                    "ns3::Traced::Value::Uint32Callback")
+    .AddTraceSource ("EcaRtsEnabled", "Whether CSMA/ECA lets RTS/CTS protect the next transmission",
+                    MakeTraceSourceAccessor (&EdcaTxopN::m_ecaRtsEnabled),
+                    "ns3::Traced::Value::BoolCallback")
     .AddTraceSource ("FsAggregated", "Number of frames aggregated",
                     MakeTraceSourceAccessor (&EdcaTxopN::m_fsAggregated),
                     "ns3::Traced::Value:Uint16Callback")
@@ -294,12 +321,12 @@ EdcaTxopN::EdcaTxopN ()
     m_ampduExist (false),
     m_fairShare (false),
     m_fsAggregation (0),
-    m_srActivationThreshold (1),
-    m_srBeingFilled (false),
-    m_srIterations (0),
-    m_srReductionFactor (1),
-    m_scheduleRecentlyReduced (false),
-    m_srPreviousCw (0),
+    m_eca (0),
+    m_ecaConfig (EcaPolicy::GetDefaultConfig ()),
+    m_drrQuantum (Seconds (0)),
+    m_drrNext (0),
+    m_drrCredited (false),
+    m_drrMpduAirtime (Seconds (0)),
     m_failures (0),
     m_collisions (0),
     m_successes (0),
@@ -309,6 +336,11 @@ EdcaTxopN::EdcaTxopN ()
     m_scheduleReductions (0),
     m_scheduleReductionAttempts (0),
     m_scheduleReductionFailed (0),
+    m_ctrlEmptySlots (0),
+    m_ctrlCollisionRate (0),
+    m_ctrlStickiness (0),
+    m_ctrlCwStepDowns (0),
+    m_ecaRtsEnabled (true),
     m_fsAggregated (0xFFFF)
 {
   NS_LOG_FUNCTION (this);
@@ -317,6 +349,8 @@ EdcaTxopN::EdcaTxopN ()
   m_dcf = new EdcaTxopN::Dcf (this);
   m_queue = CreateObject<WifiMacQueue> ();
   m_rng = new RealRandomStream ();
+  m_ecaConfig.srThreshold = 2;
+  m_ecaConfig.srActivationThreshold = 1;
   m_qosBlockedDestinations = new QosBlockedDestinations ();
   m_baManager = new BlockAckManager ();
   m_baManager->SetQueue (m_queue);
@@ -346,7 +380,9 @@ EdcaTxopN::DoDispose (void)
   delete m_qosBlockedDestinations;
   delete m_baManager;
   delete m_blockAckListener;
+  delete m_eca;
   m_transmissionListener = 0;
+  m_eca = 0;
   m_dcf = 0;
   m_rng = 0;
   m_qosBlockedDestinations = 0;
@@ -386,6 +422,18 @@ EdcaTxopN::SetManager (Ptr<DcfManager> manager)
   NS_LOG_FUNCTION (this << manager);
   m_manager = manager;
   m_manager->Add (m_dcf);
+  SelectEcaPolicy ();
+}
+
+void
+EdcaTxopN::SelectEcaPolicy (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_manager == 0)
+    {
+      return;
+    }
+  m_eca = EcaPolicy::Select (m_eca, m_dcf, m_manager, m_rng, EcaPolicy::GetTraces (this), m_ecaConfig);
 }
 
 void
@@ -483,7 +531,7 @@ EdcaTxopN::SetTxMiddle (MacTxMiddle *txMiddle)
 Ptr<MacLow>
 EdcaTxopN::Low (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_low;
 }
 
@@ -497,7 +545,7 @@ EdcaTxopN::SetLow (Ptr<MacLow> low)
 bool
 EdcaTxopN::NeedsAccess (void) const
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return !m_queue->IsEmpty () || m_currentPacket != 0 || m_baManager->HasPackets ();
 }
 
@@ -539,12 +587,12 @@ EdcaTxopN::IsFairShare (void)
 void
 EdcaTxopN::NotifyAccessGranted (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if (m_currentPacket == 0)
     {
       if (m_queue->IsEmpty () && !m_baManager->HasPackets ())
         {
-          NS_LOG_DEBUG ("queue is empty");
+          HOT_LOG_DEBUG ("queue is empty");
           return;
         }
       if (m_baManager->HasBar (m_currentBar))
@@ -554,13 +602,23 @@ EdcaTxopN::NotifyAccessGranted (void)
         }
       /* check if packets need retransmission are stored in BlockAckManager */
       m_currentPacket = m_baManager->GetNextPacket (m_currentHdr);
+      m_drrMpduAirtime = Seconds (0);
       if (m_currentPacket == 0)
         {
           if (m_queue->PeekFirstAvailable (&m_currentHdr, m_currentPacketTimestamp, m_qosBlockedDestinations) == 0)
             {
-              NS_LOG_DEBUG ("no available packets in the queue");
+              HOT_LOG_DEBUG ("no available packets in the queue");
               return;
             }
+          Mac48Address dest;
+          bool drr = m_drrQuantum.IsStrictlyPositive () && m_currentHdr.IsQosData ()
+            && !m_currentHdr.GetAddr1 ().IsGroup ()
+            && SelectDownlinkDestination (m_currentHdr.GetQosTid (), &dest);
+          if (drr)
+            {
+              m_queue->PeekByTidAndAddress (&m_currentHdr, m_currentHdr.GetQosTid (),
+                                            WifiMacHeader::ADDR1, dest, &m_currentPacketTimestamp);
+            }
           if (m_currentHdr.IsQosData () && !m_currentHdr.GetAddr1 ().IsBroadcast ()
               && m_blockAckThreshold > 0
               && !m_baManager->ExistsAgreement (m_currentHdr.GetAddr1 (), m_currentHdr.GetQosTid ())
@@ -568,7 +626,18 @@ EdcaTxopN::NotifyAccessGranted (void)
             {
               return;
             }
-          m_currentPacket = m_queue->DequeueFirstAvailable (&m_currentHdr, m_currentPacketTimestamp, m_qosBlockedDestinations);
+          if (drr)
+            {
+              m_currentPacket = m_queue->PeekByTidAndAddress (&m_currentHdr, m_currentHdr.GetQosTid (),
+                                                              WifiMacHeader::ADDR1, dest, &m_currentPacketTimestamp);
+              m_queue->Remove (m_currentPacket);
+              m_drrCredit[dest] -= m_drrMpduAirtime;
+              HOT_LOG_DEBUG ("downlink turn of " << dest << ", credit left " << m_drrCredit[dest]);
+            }
+          else
+            {
+              m_currentPacket = m_queue->DequeueFirstAvailable (&m_currentHdr, m_currentPacketTimestamp, m_qosBlockedDestinations);
+            }
           NS_ASSERT (m_currentPacket != 0);
 
           uint16_t sequence = m_txMiddle->GetNextSequenceNumberfor (&m_currentHdr);
@@ -578,7 +647,7 @@ EdcaTxopN::NotifyAccessGranted (void)
           m_currentHdr.SetNoMoreFragments ();
           m_currentHdr.SetNoRetry ();
           m_fragmentNumber = 0;
-          NS_LOG_DEBUG ("dequeued size=" << m_currentPacket->GetSize () <<
+          HOT_LOG_DEBUG ("dequeued size=" << m_currentPacket->GetSize () <<
                         ", to=" << m_currentHdr.GetAddr1 () <<
                         ", seq=" << m_currentHdr.GetSequenceControl ());
           if (m_currentHdr.IsQosData () && !m_currentHdr.GetAddr1 ().IsBroadcast ())
@@ -600,7 +669,7 @@ EdcaTxopN::NotifyAccessGranted (void)
                                 params,
                                 m_transmissionListener);
 
-      NS_LOG_DEBUG ("tx broadcast");
+      HOT_LOG_DEBUG ("tx broadcast");
     }
   else if (m_currentHdr.GetType () == WIFI_MAC_CTL_BACKREQ)
     {
@@ -632,12 +701,12 @@ EdcaTxopN::NotifyAccessGranted (void)
           Ptr<Packet> fragment = GetFragmentPacket (&hdr);
           if (IsLastFragment ())
             {
-              NS_LOG_DEBUG ("fragmenting last fragment size=" << fragment->GetSize ());
+              HOT_LOG_DEBUG ("fragmenting last fragment size=" << fragment->GetSize ());
               params.DisableNextData ();
             }
           else
             {
-              NS_LOG_DEBUG ("fragmenting size=" << fragment->GetSize ());
+              HOT_LOG_DEBUG ("fragmenting size=" << fragment->GetSize ());
               params.EnableNextData (GetNextFragmentSize ());
             }
           m_low->StartTransmission (fragment, &hdr, params,
@@ -691,14 +760,14 @@ EdcaTxopN::NotifyAccessGranted (void)
                   uint16_t totalFrames = std::pow (2, m_fsAggregation);
                   if (totalFrames == 1)
                     {
-                      NS_LOG_DEBUG ("On the zeroth backoff stage. Transmitting unicast");
+                      HOT_LOG_DEBUG ("On the zeroth backoff stage. Transmitting unicast");
                       count = totalFrames;
                     }
                     
                   while (count < totalFrames && peekedPacket != 0)
                     {
-                      NS_LOG_DEBUG ("Peeked: " << count);
-                      NS_LOG_DEBUG ("Aggregating frame " << count + 1 << " of " << totalFrames);
+                      HOT_LOG_DEBUG ("Peeked: " << count);
+                      HOT_LOG_DEBUG ("Aggregating frame " << count + 1 << " of " << totalFrames);
                       aggregated = m_aggregator->Aggregate (peekedPacket, currentAggregatedPacket,
                                                             MapSrcAddressForAggregation (peekedHdr),
                                                             MapDestAddressForAggregation (peekedHdr));
@@ -709,7 +778,7 @@ EdcaTxopN::NotifyAccessGranted (void)
                         }
                       else
                         {
-                          NS_LOG_DEBUG ("Not performing aggregation");
+                          HOT_LOG_DEBUG ("Not performing aggregation");
                           break;
                         }
                       peekedPacket = m_queue->PeekByTidAndAddress (&peekedHdr, m_currentHdr.GetQosTid (),
@@ -724,18 +793,18 @@ EdcaTxopN::NotifyAccessGranted (void)
                   m_currentHdr.SetAddr3 (m_low->GetBssid ());
                   m_currentPacket = currentAggregatedPacket;
                   currentAggregatedPacket = 0;
-                  NS_LOG_DEBUG ("tx unicast A-MSDU");
+                  HOT_LOG_DEBUG ("tx unicast A-MSDU");
                 }
             }
           if (NeedRts ())
             {
               params.EnableRts ();
-              NS_LOG_DEBUG ("tx unicast rts");
+              HOT_LOG_DEBUG ("tx unicast rts");
             }
           else
             {
               params.DisableRts ();
-              NS_LOG_DEBUG ("tx unicast");
+              HOT_LOG_DEBUG ("tx unicast");
             }
           params.DisableNextData ();
           m_low->StartTransmission (m_currentPacket, &m_currentHdr,
@@ -751,29 +820,18 @@ EdcaTxopN::NotifyAccessGranted (void)
 void 
 EdcaTxopN::NotifyInternalCollision (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   NotifyCollision ();
 }
 
 void
 EdcaTxopN::NotifyCollision (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("Notifying collision. Stickiness " << m_manager->GetStickiness ());
-  if (m_manager->GetEnvironmentForECA () && m_manager->GetStickiness () > 0)
-    {
-      NS_ASSERT (m_manager->GetStickiness () > 0);
-      m_manager->ReduceStickiness ();
-      m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
-    }
-  else
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("Notifying collision. Stickiness " << m_manager->GetStickiness ());
+  if (m_eca->NotifyCollision ())
     {
       m_collisions++;
-      if (m_manager->GetScheduleReset ())
-        ResetSrMetrics ();
-      if (!m_manager->GetHysteresisForECA ())
-        m_dcf->ResetCw ();
-      m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
     }
   RestartAccessIfNeeded ();
 }
@@ -781,18 +839,18 @@ EdcaTxopN::NotifyCollision (void)
 void
 EdcaTxopN::GotCts (double snr, WifiMode txMode)
 {
-  NS_LOG_FUNCTION (this << snr << txMode);
-  NS_LOG_DEBUG ("got cts");
+  HOT_LOG_FUNCTION (this << snr << txMode);
+  HOT_LOG_DEBUG ("got cts");
 }
 
 void
 EdcaTxopN::MissedCts (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("missed cts");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("missed cts");
   if (!NeedRtsRetransmission ())
     {
-      NS_LOG_DEBUG ("Cts Fail");
+      HOT_LOG_DEBUG ("Cts Fail");
       bool resetCurrentPacket = true;
       m_stationManager->ReportFinalRtsFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
       if (!m_txFailedCallback.IsNull ())
@@ -814,7 +872,7 @@ EdcaTxopN::MissedCts (void)
 
           if (GetBaAgreementExists (m_currentHdr.GetAddr1 (), tid))
             {
-              NS_LOG_DEBUG ("Transmit Block Ack Request");
+              HOT_LOG_DEBUG ("Transmit Block Ack Request");
               CtrlBAckRequestHeader reqHdr;
               reqHdr.SetType (COMPRESSED_BLOCK_ACK);
               reqHdr.SetStartingSequence (m_txMiddle->PeekNextSequenceNumberfor (&m_currentHdr));
@@ -882,11 +940,17 @@ EdcaTxopN::NotifyWakeUp (void)
 void
 EdcaTxopN::Queue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this << packet << &hdr);
+  HOT_LOG_FUNCTION (this << packet << &hdr);
   WifiMacTrailer fcs;
   uint32_t fullPacketSize = hdr.GetSerializedSize () + packet->GetSize () + fcs.GetSerializedSize ();
   m_stationManager->PrepareForQueue (hdr.GetAddr1 (), &hdr,
                                      packet, fullPacketSize);
+  if (m_drrQuantum.IsStrictlyPositive () && hdr.IsQosData () && !hdr.GetAddr1 ().IsGroup ()
+      && m_drrCredit.find (hdr.GetAddr1 ()) == m_drrCredit.end ())
+    {
+      m_drrDestinations.push_back (hdr.GetAddr1 ());
+      m_drrCredit[hdr.GetAddr1 ()] = Seconds (0);
+    }
   m_queue->Enqueue (packet, hdr);
   StartAccessIfNeeded ();
 }
@@ -895,12 +959,12 @@ void
 EdcaTxopN::GotAck (double snr, WifiMode txMode)
 {
   m_successes++;
-  NS_LOG_FUNCTION (this << snr << txMode);
+  HOT_LOG_FUNCTION (this << snr << txMode);
   if (!NeedFragmentation ()
       || IsLastFragment ()
       || m_currentHdr.IsQosAmsdu ())
     {
-      NS_LOG_DEBUG ("got ack. tx done.");
+      HOT_LOG_DEBUG ("got ack. tx done.");
       if (!m_txOkCallback.IsNull ())
         {
           m_txOkCallback (m_currentHdr);
@@ -928,78 +992,26 @@ EdcaTxopN::GotAck (double snr, WifiMode txMode)
         }
       m_currentPacket = 0;
 
-      /* Beginning of CSMA/ECA */
-      AddConsecutiveSuccess ();
-      m_manager->ResetStickiness ();
-
-      if (m_manager->GetEnvironmentForECA ())
-        {
-          if (!m_manager->GetHysteresisForECA ())
-            m_dcf->ResetCw ();
-
-          if (m_manager->GetScheduleReset ())
-            {
-              if (m_scheduleRecentlyReduced == true)
-                KeepScheduleReductionIfAny ();
-
-              if (m_srActivationThreshold == 0)
-                SetScheduleResetActivationThreshold ( (m_dcf->GetCwMax ()+ 1) / (m_dcf->GetCw () + 1) );
-
-              if (GetConsecutiveSuccesses () >= GetScheduleResetActivationThreshold ())
-                {
-                  if (!m_srBeingFilled)
-                    {
-                      SetScheduleResetThreshold ();
-                      uint32_t size = ((m_dcf->GetCw () + 1) / 2) + 1;
-                      m_manager->StartNewEcaBitmap (size);
-                      m_srBeingFilled = true;
-                      m_manager->SetFillingTheBitmap ();
-                      m_srIterations = GetConsecutiveSuccesses ();
-                    }
-                  else
-                    {
-                      if ( (GetConsecutiveSuccesses () - m_srIterations) >= GetScheduleResetThreshold ())
-                        {
-                          NS_LOG_DEBUG ("Checking bitmap for Schedule Reset");
-                          if (CanWeReduceTheSchedule ())
-                            {
-                              ModifyCwAccordingToScheduleReduction ();
-                            }
-                          else
-                            {
-                              NS_LOG_DEBUG ("We cannot reduce the schedule");
-                            }
-                          m_srBeingFilled = false;
-                          m_manager->SetNotFillingTheBitmap ();
-                          ResetConsecutiveSuccess ();
-                          m_srIterations = GetConsecutiveSuccesses ();
-                        }
-                    }
-                }
-            }
-          m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
-        }
-      else /* End of CSMA/ECA */
+      m_eca->NotifySuccess ();
+      if (!m_eca->GetConfig ().eca)
         {
-          m_dcf->ResetCw ();
-          m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
           RestartAccessIfNeeded ();
         }
     }
   else
     {
-      NS_LOG_DEBUG ("got ack. tx not done, size=" << m_currentPacket->GetSize ());
+      HOT_LOG_DEBUG ("got ack. tx not done, size=" << m_currentPacket->GetSize ());
     }
 }
 
 void
 EdcaTxopN::MissedAck (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("missed ack");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("missed ack");
   if (!NeedDataRetransmission ())
     {
-      NS_LOG_DEBUG ("Ack Fail");
+      HOT_LOG_DEBUG ("Ack Fail");
       m_stationManager->ReportFinalDataFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
       bool resetCurrentPacket = true;
       if (!m_txFailedCallback.IsNull ())
@@ -1021,7 +1033,7 @@ EdcaTxopN::MissedAck (void)
           if (GetBaAgreementExists (m_currentHdr.GetAddr1 (), tid))
             {
               //send Block ACK Request in order to shift WinStart at the receiver
-              NS_LOG_DEBUG ("Transmit Block Ack Request");
+              HOT_LOG_DEBUG ("Transmit Block Ack Request");
               CtrlBAckRequestHeader reqHdr;
               reqHdr.SetType (COMPRESSED_BLOCK_ACK);
               reqHdr.SetStartingSequence (m_txMiddle->PeekNextSequenceNumberfor (&m_currentHdr));
@@ -1055,24 +1067,12 @@ EdcaTxopN::MissedAck (void)
     }
   else
     {
-      NS_LOG_DEBUG ("Retransmit");
+      HOT_LOG_DEBUG ("Retransmit");
       m_currentHdr.SetRetry ();
 
-      /* CSMA/ECA */
-      if (m_manager->GetStickiness () == 0)
+      if (m_eca->NotifyFailure ())
         {
           m_failures++;
-          ResetConsecutiveSuccess ();
-          if (m_manager->GetScheduleReset ())
-            ResetSrMetrics ();
-          m_dcf->UpdateFailedCw ();
-          m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-        }
-      else
-        {
-          NS_ASSERT (m_manager->GetStickiness () > 0);
-          m_manager->ReduceStickiness ();
-          m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
         }
     }
   RestartAccessIfNeeded ();
@@ -1081,20 +1081,20 @@ EdcaTxopN::MissedAck (void)
 void
 EdcaTxopN::MissedBlockAck (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("missed block ack");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("missed block ack");
   if (NeedBarRetransmission ())
     {
       if (!GetAmpduExist ())
         {
           //should i report this to station addressed by ADDR1?
-          NS_LOG_DEBUG ("Retransmit block ack request");
+          HOT_LOG_DEBUG ("Retransmit block ack request");
           m_currentHdr.SetRetry ();
         }
       else
         {
           //standard says when loosing a BlockAck originator may send a BAR page 139
-          NS_LOG_DEBUG ("Transmit Block Ack Request");
+          HOT_LOG_DEBUG ("Transmit Block Ack Request");
           CtrlBAckRequestHeader reqHdr;
           reqHdr.SetType (COMPRESSED_BLOCK_ACK);
           uint8_t tid = 0;
@@ -1140,7 +1140,7 @@ EdcaTxopN::MissedBlockAck (void)
     }
   else
     {
-      NS_LOG_DEBUG ("Block Ack Request Fail");
+      HOT_LOG_DEBUG ("Block Ack Request Fail");
       //to reset the dcf.
       m_currentPacket = 0;
       m_dcf->ResetCw ();
@@ -1158,7 +1158,7 @@ EdcaTxopN::GetMsduAggregator (void) const
 void
 EdcaTxopN::RestartAccessIfNeeded (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if ((m_currentPacket != 0
        || !m_queue->IsEmpty () || m_baManager->HasPackets ())
       && !m_dcf->IsAccessRequested ())
@@ -1170,7 +1170,7 @@ EdcaTxopN::RestartAccessIfNeeded (void)
 void
 EdcaTxopN::StartAccessIfNeeded (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if (m_currentPacket == 0
       && (!m_queue->IsEmpty () || m_baManager->HasPackets ())
       && !m_dcf->IsAccessRequested ())
@@ -1182,15 +1182,16 @@ EdcaTxopN::StartAccessIfNeeded (void)
 bool
 EdcaTxopN::NeedRts (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedRts (m_currentHdr.GetAddr1 (), &m_currentHdr,
-                                    m_currentPacket);
+                                    m_currentPacket)
+         && m_eca->IsProtectionEnabled ();
 }
 
 bool
 EdcaTxopN::NeedRtsRetransmission (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedRtsRetransmission (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                                   m_currentPacket);
 }
@@ -1198,7 +1199,7 @@ EdcaTxopN::NeedRtsRetransmission (void)
 bool
 EdcaTxopN::NeedDataRetransmission (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedDataRetransmission (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                                    m_currentPacket);
 }
@@ -1240,8 +1241,8 @@ EdcaTxopN::NextFragment (void)
 void
 EdcaTxopN::StartNext (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("start next packet fragment");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("start next packet fragment");
   /* this callback is used only for fragments. */
   NextFragment ();
   WifiMacHeader hdr;
@@ -1271,29 +1272,17 @@ EdcaTxopN::Cancel (void)
 void
 EdcaTxopN::EndTxNoAck (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("a transmission that did not require an ACK just finished");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("a transmission that did not require an ACK just finished");
   m_currentPacket = 0;
-
-  if (!m_manager->GetHysteresisForECA ())
-    m_dcf->ResetCw ();
-  
-  if (m_manager->GetEnvironmentForECA ())
-    {
-      m_dcf->StartBackoffNow (deterministicBackoff (m_dcf->GetCw ()));
-    }
-  else
-    {
-      m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-    }
-  
+  m_eca->NotifyTxNoAck ();
   StartAccessIfNeeded ();
 }
 
 bool
 EdcaTxopN::NeedFragmentation (void) const
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   return m_stationManager->NeedFragmentation (m_currentHdr.GetAddr1 (), &m_currentHdr,
                                               m_currentPacket);
 }
@@ -1362,7 +1351,7 @@ EdcaTxopN::SetAccessCategory (enum AcIndex ac)
 Mac48Address
 EdcaTxopN::MapSrcAddressForAggregation (const WifiMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this << &hdr);
+  HOT_LOG_FUNCTION (this << &hdr);
   Mac48Address retval;
   if (m_typeOfStation == STA || m_typeOfStation == ADHOC_STA)
     {
@@ -1378,7 +1367,7 @@ EdcaTxopN::MapSrcAddressForAggregation (const WifiMacHeader &hdr)
 Mac48Address
 EdcaTxopN::MapDestAddressForAggregation (const WifiMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this << &hdr);
+  HOT_LOG_FUNCTION (this << &hdr);
   Mac48Address retval;
   if (m_typeOfStation == AP || m_typeOfStation == ADHOC_STA)
     {
@@ -1402,7 +1391,7 @@ EdcaTxopN::SetMsduAggregator (Ptr<MsduAggregator> aggr)
 void
 EdcaTxopN::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this << packet << &hdr);
+  HOT_LOG_FUNCTION (this << packet << &hdr);
   WifiMacTrailer fcs;
   uint32_t fullPacketSize = hdr.GetSerializedSize () + packet->GetSize () + fcs.GetSerializedSize ();
   m_stationManager->PrepareForQueue (hdr.GetAddr1 (), &hdr,
@@ -1433,6 +1422,37 @@ EdcaTxopN::GotAddBaResponse (const MgtAddBaResponseHeader *respHdr, Mac48Address
   RestartAccessIfNeeded ();
 }
 
+uint16_t
+EdcaTxopN::InstallBlockAckAgreement (Mac48Address recipient, uint8_t tid,
+                                     MgtAddBaResponseHeader *respHdr)
+{
+  NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
+  uint16_t startingSequence = m_txMiddle->GetNextSeqNumberByTidAndAddress (tid, recipient);
+
+  //Same request SendAddBaRequest would have built
+  MgtAddBaRequestHeader reqHdr;
+  reqHdr.SetAmsduSupport (true);
+  reqHdr.SetImmediateBlockAck ();
+  reqHdr.SetTid (tid);
+  reqHdr.SetBufferSize (0);
+  reqHdr.SetTimeout (m_blockAckInactivityTimeout);
+  reqHdr.SetStartingSequence (startingSequence);
+  m_baManager->CreateAgreement (&reqHdr, recipient);
+
+  //Same response RegularWifiMac::SendAddBaResponse would have built
+  StatusCode code;
+  code.SetSuccess ();
+  respHdr->SetStatusCode (code);
+  respHdr->SetAmsduSupport (true);
+  respHdr->SetImmediateBlockAck ();
+  respHdr->SetTid (tid);
+  respHdr->SetBufferSize (1023);
+  respHdr->SetTimeout (m_blockAckInactivityTimeout);
+
+  GotAddBaResponse (respHdr, recipient);
+  return startingSequence;
+}
+
 void
 EdcaTxopN::GotDelBaFrame (const MgtDelBaHeader *delBaHdr, Mac48Address recipient)
 {
@@ -1444,8 +1464,8 @@ EdcaTxopN::GotDelBaFrame (const MgtDelBaHeader *delBaHdr, Mac48Address recipient
 void
 EdcaTxopN::GotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac48Address recipient, WifiMode txMode)
 {
-  NS_LOG_FUNCTION (this << blockAck << recipient);
-  NS_LOG_DEBUG ("got block ack from=" << recipient);
+  HOT_LOG_FUNCTION (this << blockAck << recipient);
+  HOT_LOG_DEBUG ("got block ack from=" << recipient);
   m_baManager->NotifyGotBlockAck (blockAck, recipient, txMode);
   if (!m_txOkCallback.IsNull ())
     {
@@ -1487,7 +1507,7 @@ void EdcaTxopN::SetAmpduExist (bool ampdu)
 void
 EdcaTxopN::CompleteTx (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   if (m_currentHdr.IsQosData () && m_currentHdr.IsQosBlockAck ())
     {
       if (!m_currentHdr.IsRetry ())
@@ -1715,7 +1735,7 @@ EdcaTxopN::DoInitialize ()
 {
   NS_LOG_FUNCTION (this);
   m_dcf->ResetCw ();
-  m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
+  m_eca->StartRandomBackoff ();
   ns3::Dcf::DoInitialize ();
 }
 
@@ -1750,19 +1770,11 @@ EdcaTxopN::GetAssignedBackoff (void)
 uint32_t
 EdcaTxopN::GetConsecutiveSuccesses (void)
 {
-  return m_consecutiveSuccess;
-}
-
-void
-EdcaTxopN::AddConsecutiveSuccess (void)
-{
-  m_consecutiveSuccess++;
-}
-
-void
-EdcaTxopN::ResetConsecutiveSuccess (void)
-{
-  m_consecutiveSuccess = 0;
+  if (m_eca == 0)
+    {
+      return 0;
+    }
+  return m_eca->GetState ().consecutiveSuccess;
 }
 
 void
@@ -1779,223 +1791,231 @@ EdcaTxopN::ResetStats (void)
   m_txAttempts = 0;
   m_boCounter = 0xFFFFFFFF;
   m_ecaBitmap = false;
-  m_consecutiveSuccess = 0;
-  m_settingThreshold = false;
-  m_scheduleResetThreshold = 2;
-  m_scheduleResetMode = false;
-  m_scheduleResetConservative = false;
-  m_dcf->StartBackoffNow (m_rng->GetNext (0, m_dcf->GetCw ()));
-}
-
-uint32_t
-EdcaTxopN::deterministicBackoff (uint32_t cw)
-{
-  uint32_t tmp = ceil(cw / 2) + 1;
-  if(!m_settingThreshold)
+  m_ecaConfig.scheduleReduction = ECA_SR_HALVING;
+  m_ecaConfig.conservative = false;
+  m_ecaConfig.srWindow = 0;
+  m_ecaConfig.controller = false;
+  m_ecaConfig.rtsSuppressAfter = 0;
+  m_ctrlCwStepDowns = 0;
+  m_ecaRtsEnabled = true;
+  SelectEcaPolicy ();
+  if (m_eca == 0)
     {
-      m_boCounter = 0xFFFFFFFF;
-      m_boCounter = tmp;
+      return;
     }
-  m_settingThreshold = false;
-  return tmp;
+  m_eca->ResetState ();
+  m_eca->StartRandomBackoff ();
 }
+
 bool
 EdcaTxopN::GetScheduleResetMode (void)
 {
-  return m_scheduleResetMode;
+  return m_ecaConfig.scheduleReduction == ECA_SR_RESET;
 }
 
 void
 EdcaTxopN::SetScheduleResetMode (void)
 {
-  m_scheduleResetMode = true;
+  m_ecaConfig.scheduleReduction = ECA_SR_RESET;
+  SelectEcaPolicy ();
 }
 
-bool
-EdcaTxopN::CanWeReduceTheSchedule (void)
-{
-  bool canI = false;
-  std::vector<bool> *bitmap = m_manager->GetBitmap ();
-  NS_LOG_DEBUG ("Got the bitmap from DcfManager " << bitmap->size ());
-  
-  /* Updating the traced value */
-  m_ecaBitmap = (std::vector<bool>*) 0;
-  m_ecaBitmap = bitmap;
-
-  /* Checking the possibility of a schedule reduction */
-  uint32_t currentSize = bitmap->size ();
-  if (!GetScheduleResetMode ())
-    {
-      /* That is, a Schedule Halving */
-      /* Debugging the bitmap */
-      NS_LOG_DEBUG ("Checking for Schedule Halving");
-      uint32_t slot = 0; 
-      for (std::vector<bool>::iterator i = bitmap->begin (); i != bitmap->end (); i++, slot++)
-        {
-          NS_LOG_DEBUG ("Bitmap position " << slot << " value: " << *i);
-        }
-      /* End of debug */
-
-      uint32_t midpoint = (currentSize - 1) / 2;
-      if (bitmap->at (midpoint) == 0)
-        {
-          NS_LOG_DEBUG ("A schedule halving is possible. Size: " << currentSize );
-          canI = true;
-          m_srReductionFactor = 2;
-        }
-    }
-  else
-    {
-      /* Debugging the bitmap */
-      NS_LOG_DEBUG ("Checking for Schedule Reset");
-      uint32_t slot = 0; 
-      for (std::vector<bool>::iterator i = bitmap->begin (); i != bitmap->end (); i++, slot++)
-        {
-          NS_LOG_DEBUG ("Bitmap position " << slot << " value: " << *i);
-        }
-      /* End of debug */
-      
-
-      uint32_t maxStage =  log2 ((m_dcf->GetCw () + 1) / (m_dcf->GetCwMin () + 1));
-      if(maxStage > 1)
-        {
-          for (uint32_t i = 0; i <= maxStage; i++)
-            {
-              uint32_t position = pow (2,i) * std::ceil( (m_dcf->GetCwMin () + 1) / 2);
-              NS_ASSERT (position < currentSize);
-              // std::cout << "checking for stage : " << i << ", maxStage: " << maxStage << std::endl;
-
-              if (bitmap->at (position) == 0)
-              {
-                NS_LOG_DEBUG ("A schedule reset is possible. Position: " << position );
-                canI = true;
-                m_srReductionFactor = (m_dcf->GetCw () + 1) / (pow (2,i) * (m_dcf->GetCwMin () + 1) );
-                // std::cout << "\tgetting out, m_srReductionFactor: " << m_srReductionFactor << ", pos: " << position << std::endl;
-                break;
-              }
-            }
-        }
-        else if (maxStage == 1)
-        {
-          canI = true;
-          m_srReductionFactor = 1;
-        }
-    }
-
-  /* Updating traced values */
-  m_scheduleReductionAttempts++;
-  if (canI == true)
-    {
-      m_scheduleReductions++;
-    }
-  else
-    {
-      m_scheduleReductionFailed++;
-    }
-  /* Done updating */
-  return canI;
+void
+EdcaTxopN::SetScheduleReductionWindow (uint32_t cycles)
+{
+  NS_LOG_FUNCTION (this << cycles);
+  m_ecaConfig.srWindow = cycles;
+  SelectEcaPolicy ();
 }
 
-uint32_t
-EdcaTxopN::GetScheduleResetThreshold (void)
+void
+EdcaTxopN::SetEcaController (double targetEmptySlots, double targetCollisions,
+                             uint32_t window, uint32_t maxStickiness)
 {
-  return m_scheduleResetThreshold;
+  NS_LOG_FUNCTION (this << targetEmptySlots << targetCollisions << window << maxStickiness);
+  NS_ASSERT (window > 0);
+  m_ecaConfig.controller = true;
+  m_ecaConfig.targetEmptySlots = targetEmptySlots;
+  m_ecaConfig.targetCollisions = targetCollisions;
+  m_ecaConfig.controllerWindow = window;
+  m_ecaConfig.maxStickiness = maxStickiness;
+  SelectEcaPolicy ();
 }
 
 void
-EdcaTxopN::SetScheduleResetThreshold (void)
+EdcaTxopN::SetEcaRtsSuppression (uint32_t successes)
 {
-  m_settingThreshold = true;
-
-  if(m_scheduleResetConservative)
-    {
-      m_scheduleResetThreshold = ceil (((m_dcf->GetCwMax () + 1) / 2) / 
-        ( deterministicBackoff (m_dcf->GetCw ())));
-    }
-  else
-    {
-      m_scheduleResetThreshold = 2;
-    }
+  NS_LOG_FUNCTION (this << successes);
+  m_ecaConfig.rtsSuppressAfter = successes;
+  SelectEcaPolicy ();
 }
 
 void
 EdcaTxopN::SetScheduleConservative (void)
 {
-  m_scheduleResetConservative = true;
+  m_ecaConfig.conservative = true;
+  SelectEcaPolicy ();
 }
 
 void 
 EdcaTxopN::SetScheduleResetActivationThreshold (uint32_t thresh)
 {
-  m_srActivationThreshold = thresh;
+  m_ecaConfig.srActivationThreshold = thresh;
+  if (m_eca != 0)
+    {
+      m_eca->SetScheduleResetActivationThreshold (thresh);
+    }
 }
 
 uint32_t
 EdcaTxopN::GetScheduleResetActivationThreshold (void)
 {
-  return m_srActivationThreshold;
+  if (m_eca == 0)
+    {
+      return m_ecaConfig.srActivationThreshold;
+    }
+  return m_eca->GetState ().srActivationThreshold;
 }
 
 void
-EdcaTxopN::ModifyCwAccordingToScheduleReduction (void)
+EdcaTxopN::SetAggregationWithFairShare (void)
 {
-  m_srPreviousCw =  m_dcf->GetCw ();
-  uint32_t factor = GetScheduleReductionFactor ();
-  NS_ASSERT (factor > 0);
-
-  uint32_t reduced = std::max ( ((m_dcf->GetCw () + 1) / factor) - 1, m_dcf->GetCwMin () );
-  
-  NS_ASSERT (reduced % 2 != 0);
-  m_dcf->SetCw (reduced);
+  m_fsAggregation = 0;
+  if (GetConsecutiveSuccesses () > 0)
+    {
+      if (m_dcf->GetCw () > m_dcf->GetCwMin ())
+        {
+          m_fsAggregation =  log2 ((m_dcf->GetCw () + 1) / (m_dcf->GetCwMin () + 1));
+           // Updating traced value 
+          m_fsAggregated = 0xFFFF;
+          m_fsAggregated = m_fsAggregation;
+          NS_LOG_DEBUG (m_fsAggregation);
+        }
+    }
+}
 
-  NS_LOG_DEBUG ("Schedule Reset modified Cw from: " << m_srPreviousCw << " to: " << m_dcf->GetCw ());
+uint16_t
+EdcaTxopN::GetFairShareAmpduLimit (void)
+{
+  SetAggregationWithFairShare ();
+  uint16_t totalFrames = std::pow (2, std::min<uint16_t> (m_fsAggregation, 6));
+  HOT_LOG_DEBUG ("Fair share A-MPDU of up to " << totalFrames << " MPDUs");
+  return totalFrames;
+}
 
-  if (m_manager->UseDynamicStickiness ())
-    m_manager->IncreaseStickiness ();
-  m_scheduleRecentlyReduced = true;
+void
+EdcaTxopN::SetDownlinkFairShare (Time quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_drrQuantum = quantum;
+  m_drrDestinations.clear ();
+  m_drrCredit.clear ();
+  m_drrNext = 0;
+  m_drrCredited = false;
 }
 
-uint32_t
-EdcaTxopN::GetScheduleReductionFactor (void)
+Time
+EdcaTxopN::GetDownlinkMpduAirtime (Mac48Address dest, Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  return m_srReductionFactor;
+  WifiMacTrailer fcs;
+  uint32_t size = hdr.GetSerializedSize () + packet->GetSize () + fcs.GetSerializedSize ();
+  WifiTxVector txVector = m_stationManager->GetDataTxVector (dest, &hdr, packet, size);
+  uint64_t dataRate = txVector.GetMode ().GetDataRate (txVector.GetChannelWidth (),
+                                                       txVector.IsShortGuardInterval (),
+                                                       txVector.GetNss ());
+  return NanoSeconds (size * 8 * 1000000000ULL / dataRate);
 }
 
-void
-EdcaTxopN::ResetSrMetrics (void)
+bool
+EdcaTxopN::SelectDownlinkDestination (uint8_t tid, Mac48Address *dest)
 {
-  m_srBeingFilled = false;
-  m_manager->SetNotFillingTheBitmap ();
-  if (m_scheduleRecentlyReduced == true)
+  HOT_LOG_FUNCTION (this << (uint16_t)tid);
+  uint32_t n = m_drrDestinations.size ();
+  bool backlogged = true;
+  while (backlogged)
     {
-      NS_LOG_DEBUG ("Resetting the chances made by Schedule Reset. Cw back to: " << m_srPreviousCw);
-      m_dcf->SetCw (m_srPreviousCw);
-      // std::cout << "Reversing to: " << m_srPreviousCw << std::endl;
+      backlogged = false;
+      for (uint32_t k = 0; k < n; k++)
+        {
+          Mac48Address candidate = m_drrDestinations.at (m_drrNext);
+          if (!m_qosBlockedDestinations->IsBlocked (candidate, tid))
+            {
+              WifiMacHeader hdr;
+              Time tstamp;
+              Ptr<const Packet> packet = m_queue->PeekByTidAndAddress (&hdr, tid, WifiMacHeader::ADDR1,
+                                                                        candidate, &tstamp);
+              if (packet == 0)
+                {
+                  /* Credit is not saved while there is nothing to send */
+                  m_drrCredit[candidate] = Seconds (0);
+                }
+              else
+                {
+                  backlogged = true;
+                  if (!m_drrCredited)
+                    {
+                      m_drrCredit[candidate] += m_drrQuantum;
+                      m_drrCredited = true;
+                    }
+                  Time airtime = GetDownlinkMpduAirtime (candidate, packet, hdr);
+                  if (m_drrCredit[candidate] >= airtime)
+                    {
+                      *dest = candidate;
+                      m_drrMpduAirtime = airtime;
+                      return true;
+                    }
+                }
+            }
+          m_drrNext = (m_drrNext + 1) % n;
+          m_drrCredited = false;
+        }
     }
-  m_scheduleRecentlyReduced = false;
+  return false;
 }
 
-void
-EdcaTxopN::KeepScheduleReductionIfAny (void)
+uint16_t
+EdcaTxopN::GetDestinationAmpduLimit (Mac48Address dest)
 {
-  m_scheduleRecentlyReduced = false;
+  if (m_drrMpduAirtime.IsZero () || dest != m_currentHdr.GetAddr1 ())
+    {
+      return 64;
+    }
+  /* The first MPDU was paid for when it was dequeued, the others are
+   * charged by CompleteAmpduAggregation once the A-MPDU is built */
+  Time credit = m_drrCredit.find (dest)->second;
+  uint32_t extra = std::min<uint32_t> (credit.GetNanoSeconds () / m_drrMpduAirtime.GetNanoSeconds (), 63);
+  HOT_LOG_DEBUG ("downlink A-MPDU of up to " << extra + 1 << " MPDUs to " << dest);
+  return extra + 1;
 }
 
 void
-EdcaTxopN::SetAggregationWithFairShare (void)
+EdcaTxopN::CompleteAmpduAggregation (Mac48Address dest, uint32_t nMpdus)
 {
-  m_fsAggregation = 0;
-  if (GetConsecutiveSuccesses () > 0)
+  if (m_drrMpduAirtime.IsZero () || dest != m_currentHdr.GetAddr1 () || nMpdus == 0)
     {
-      if (m_dcf->GetCw () > m_dcf->GetCwMin ())
-        {
-          m_fsAggregation =  log2 ((m_dcf->GetCw () + 1) / (m_dcf->GetCwMin () + 1));
-           // Updating traced value 
-          m_fsAggregated = 0xFFFF;
-          m_fsAggregated = m_fsAggregation;
-          NS_LOG_DEBUG (m_fsAggregation);
-        }
+      return;
     }
+  m_drrCredit[dest] -= NanoSeconds (nMpdus * m_drrMpduAirtime.GetNanoSeconds ());
+  HOT_LOG_DEBUG ("downlink A-MPDU with " << nMpdus << " more MPDUs to " << dest << ", credit left " << m_drrCredit[dest]);
+}
+
+EcaTxopSnapshot
+EdcaTxopN::GetEcaSnapshot (void) const
+{
+  NS_ASSERT_MSG (m_eca != 0, "No CSMA/ECA state before SetManager");
+  EcaTxopSnapshot snapshot;
+  snapshot.dcf = m_dcf->GetSnapshot ();
+  m_eca->SaveSnapshot (&snapshot);
+  return snapshot;
+}
+
+void
+EdcaTxopN::RestoreEcaSnapshot (const EcaTxopSnapshot &snapshot)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_eca != 0, "No CSMA/ECA state before SetManager");
+  m_dcf->RestoreSnapshot (snapshot.dcf);
+  m_eca->RestoreSnapshot (snapshot);
 }
 
 } //namespace ns3
@@ -30,10 +30,12 @@
 #include "wifi-remote-station-manager.h"
 #include "qos-utils.h"
 #include "dcf.h"
+#include "eca-policy.h"
 #include "ctrl-headers.h"
 #include "block-ack-manager.h"
 #include <map>
 #include <list>
+#include <vector>
 //Adding the capability of functioning as a trace source
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
@@ -42,6 +44,7 @@ namespace ns3 {
 
 class DcfState;
 class DcfManager;
+struct EcaTxopSnapshot;
 class MacLow;
 class MacTxMiddle;
 class WifiMac;
@@ -263,6 +266,20 @@ public:
    */
   void MissedBlockAck (void);
   void GotAddBaResponse (const MgtAddBaResponseHeader *respHdr, Mac48Address recipient);
+  /**
+   * Establish an originator block ack agreement with <i>recipient</i>
+   * without exchanging ADDBA frames over the air. This is meant for
+   * statically configured topologies where the recipient side is set up
+   * with MacLow::CreateBlockAckAgreement using the returned header.
+   *
+   * \param recipient address of the recipient
+   * \param tid traffic ID of the agreement
+   * \param respHdr filled with the ADDBA response the recipient would have sent
+   *
+   * \return the starting sequence number of the agreement
+   */
+  uint16_t InstallBlockAckAgreement (Mac48Address recipient, uint8_t tid,
+                                     MgtAddBaResponseHeader *respHdr);
   void GotDelBaFrame (const MgtDelBaHeader *delBaHdr, Mac48Address recipient);
   /**
    * Event handler when an ACK is received.
@@ -421,24 +438,79 @@ public:
   void SetFairShare (void);
   bool IsFairShare (void);
   void ResetStats (void);
-  uint32_t deterministicBackoff (uint32_t cw);
-  bool CanWeReduceTheSchedule (void);
   uint32_t GetConsecutiveSuccesses (void);
-  void AddConsecutiveSuccess (void);
-  void ResetConsecutiveSuccess (void);
-  uint32_t GetScheduleResetThreshold (void);
-  void SetScheduleResetThreshold (void);
   void SetScheduleConservative (void);
   bool GetScheduleResetMode (void);
   void SetScheduleResetActivationThreshold (uint32_t thresh);
   uint32_t GetScheduleResetActivationThreshold (void);
   void SetScheduleResetMode (void);
-  void ModifyCwAccordingToScheduleReduction (void);
-  uint32_t GetScheduleReductionFactor (void);
-  void ResetSrMetrics (void);
-  void KeepScheduleReductionIfAny (void);
+  /**
+   * Check the schedule after every success against the slots used
+   * in the last \p cycles cycles, instead of filling and checking one
+   * bitmap at a time.
+   *
+   * \param cycles the number of cycles in the window, 0 to disable
+   */
+  void SetScheduleReductionWindow (uint32_t cycles);
+  /**
+   * Let CSMA/ECA adapt its stickiness and step the CW down from the
+   * slots observed during the backoff. Every \p window transmissions,
+   * stickiness is lowered if the failure rate exceeds
+   * \p targetCollisions and raised (up to \p maxStickiness) otherwise.
+   * In that case, if more than \p targetEmptySlots of the slots were
+   * empty, the CW drops one stage.
+   *
+   * \param targetEmptySlots empty slot fraction target
+   * \param targetCollisions failure rate target
+   * \param window transmissions per decision
+   * \param maxStickiness upper bound of the stickiness
+   */
+  void SetEcaController (double targetEmptySlots, double targetCollisions,
+                         uint32_t window, uint32_t maxStickiness);
+  /**
+   * Only let RTS/CTS protect transmissions while CSMA/ECA is not on a
+   * collision-free deterministic schedule: protection is switched off
+   * after \p successes successes without failures, and back on by the
+   * next failure or collision.
+   *
+   * \param successes successes before switching RTS/CTS off, 0 to disable
+   */
+  void SetEcaRtsSuppression (uint32_t successes);
+  EcaTxopSnapshot GetEcaSnapshot (void) const;
+  void RestoreEcaSnapshot (const EcaTxopSnapshot &snapshot);
   uint32_t GetAssignedBackoff (void);
   void SetAggregationWithFairShare (void);
+  /**
+   * Fair share at the A-MPDU level: the number of MPDUs MacLow may
+   * aggregate is 2^stage, where stage is the current backoff stage.
+   *
+   * \return the maximum number of MPDUs in the next A-MPDU
+   */
+  uint16_t GetFairShareAmpduLimit (void);
+  /**
+   * Serve unicast destinations (e.g., the stations of an AP) in deficit
+   * round robin instead of in queue order. Each turn, a destination
+   * with queued packets earns \p quantum of airtime and keeps the
+   * channel access opportunities while its credit pays for an MPDU.
+   *
+   * \param quantum airtime credited per turn, 0 to disable
+   */
+  void SetDownlinkFairShare (Time quantum);
+  /**
+   * \param dest the receiver of the A-MPDU about to be built
+   * \return the number of MPDUs the credit of \p dest pays for,
+   *         64 if the current packet was not chosen by the round robin
+   */
+  uint16_t GetDestinationAmpduLimit (Mac48Address dest);
+  /**
+   * Charge the MPDUs that MacLow took from the queue into an A-MPDU for
+   * \p dest to its credit. The current packet is not charged again: it
+   * was paid for when it was dequeued, retransmissions included.
+   *
+   * \param dest the receiver of the A-MPDU
+   * \param nMpdus the number of MPDUs taken from the queue
+   */
+  void CompleteAmpduAggregation (Mac48Address dest, uint32_t nMpdus);
 
   //For tracing the bitmap
   typedef void (* TracedEcaBitmap) (std::vector<bool> *bmold, std::vector<bool> *bmnew); 
@@ -517,6 +589,21 @@ private:
    * \return true if we tried to set up block ACK, false otherwise
    */
   bool SetupBlockAckIfNeeded ();
+  /**
+   * Find the destination whose round robin turn it is, crediting
+   * quanta until one of the destinations with queued packets can pay
+   * for an MPDU.
+   *
+   * \param tid the TID of the packets to send
+   * \param dest the chosen destination
+   *
+   * \return false if no destination has packets for \p tid
+   */
+  bool SelectDownlinkDestination (uint8_t tid, Mac48Address *dest);
+  /**
+   * \return the time needed to send \p packet to \p dest, without preamble
+   */
+  Time GetDownlinkMpduAirtime (Mac48Address dest, Ptr<const Packet> packet, const WifiMacHeader &hdr);
   /**
    * Sends an ADDBA Request to establish a block ack agreement with sta
    * addressed by <i>recipient</i> for tid <i>tid</i>.
@@ -546,6 +633,11 @@ private:
    * if an established block ack agreement exists with the receiver.
    */
   void VerifyBlockAck (void);
+  /**
+   * Build the CSMA/ECA policy matching the DcfManager environment
+   * and the schedule reduction settings, keeping the current state.
+   */
+  void SelectEcaPolicy (void);
 
   AcIndex m_ac;
   class Dcf;
@@ -553,6 +645,7 @@ private:
   class AggregationCapableTransmissionListener;
   friend class Dcf;
   friend class TransmissionListener;
+  friend class EcaPolicy;
   Dcf *m_dcf;
   Ptr<DcfManager> m_manager;
   Ptr<WifiMacQueue> m_queue;
@@ -588,17 +681,15 @@ private:
 
   bool m_fairShare;
   uint16_t m_fsAggregation;
-  uint32_t m_consecutiveSuccess;
-  bool m_settingThreshold;
-  uint32_t m_scheduleResetThreshold;
-  bool m_scheduleResetConservative;
-  bool m_scheduleResetMode;
-  uint32_t m_srActivationThreshold;
-  bool m_srBeingFilled;
-  uint32_t m_srIterations;
-  uint32_t m_srReductionFactor;
-  bool m_scheduleRecentlyReduced;
-  uint32_t m_srPreviousCw;
+  EcaPolicy *m_eca;            //!< 0 until SetManager
+  EcaPolicyConfig m_ecaConfig; //!< CSMA/ECA settings of this transmitter
+
+  Time m_drrQuantum;                             //!< airtime credited per round robin turn, 0 if disabled
+  std::vector<Mac48Address> m_drrDestinations;   //!< round robin order (first packet queued)
+  std::map<Mac48Address, Time> m_drrCredit;      //!< airtime credit of every destination
+  uint32_t m_drrNext;                            //!< index of the destination whose turn it is
+  bool m_drrCredited;                            //!< whether it already got the quantum of this turn
+  Time m_drrMpduAirtime;                         //!< airtime of an MPDU of the current packet, 0 if not chosen by the round robin
 
 
   TracedValue<uint64_t> m_failures;
@@ -610,6 +701,11 @@ private:
   TracedValue<uint32_t> m_scheduleReductions;
   TracedValue<uint32_t> m_scheduleReductionAttempts;
   TracedValue<uint32_t> m_scheduleReductionFailed;
+  TracedValue<double> m_ctrlEmptySlots;
+  TracedValue<double> m_ctrlCollisionRate;
+  TracedValue<uint32_t> m_ctrlStickiness;
+  TracedValue<uint32_t> m_ctrlCwStepDowns;
+  TracedValue<bool> m_ecaRtsEnabled;
   TracedValue<uint16_t> m_fsAggregated;
 };
 
@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Luis Sanabria-Russo <luis.sanabria@upf.edu>
+ */
+
+#ifndef HOT_LOG_H
+#define HOT_LOG_H
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <iostream>
+
+/**
+ * Logging of the per slot and per frame paths of DcfManager, DcaTxop,
+ * EdcaTxopN, MacLow and EcaPolicy.
+ *
+ * These behave as NS_LOG_FUNCTION and NS_LOG_DEBUG in debug builds, so
+ * setLog keeps working. Defining WIFI_QUIET_HOT_PATHS, e.g.
+ *
+ *   CXXFLAGS="-DWIFI_QUIET_HOT_PATHS" ./waf configure
+ *
+ * compiles them out, while the rest of the logging of the build stays
+ * available. As in the optimized build profile, the arguments are kept
+ * in dead code, so variables only used in the logs do not warn.
+ *
+ * The saturated grid of benchmark.pl measures the difference between
+ * the two builds; see its header for the commands.
+ */
+#if defined (NS3_LOG_ENABLE) && !defined (WIFI_QUIET_HOT_PATHS)
+
+#define HOT_LOG_FUNCTION(parameters) NS_LOG_FUNCTION (parameters)
+#define HOT_LOG_DEBUG(msg) NS_LOG_DEBUG (msg)
+#define HOT_LOG_INFO(msg) NS_LOG_INFO (msg)
+#define MY_DEBUG(x) \
+  NS_LOG_DEBUG (Simulator::Now () << " " << this << " " << x)
+
+#else
+
+#define HOT_LOG_NOOP(msg) \
+  do { if (false) { std::clog << msg; } } while (false)
+
+#define HOT_LOG_FUNCTION(parameters) HOT_LOG_NOOP (parameters)
+#define HOT_LOG_DEBUG(msg) HOT_LOG_NOOP (msg)
+#define HOT_LOG_INFO(msg) HOT_LOG_NOOP (msg)
+#define MY_DEBUG(x) HOT_LOG_NOOP (x)
+
+#endif
+
+#endif /* HOT_LOG_H */
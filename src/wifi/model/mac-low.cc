@@ -37,13 +37,11 @@
 #include "ampdu-tag.h"
 #include "wifi-mac-queue.h"
 #include "mpdu-standard-aggregator.h"
+#include "hot-log.h"
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT std::clog << "[mac=" << m_self << "] "
 
- #define MY_DEBUG(x) \
-  NS_LOG_DEBUG (Simulator::Now () << " " << this << " " << x)
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("MacLow");
@@ -130,6 +128,20 @@ MacLowAggregationCapableTransmissionListener::GetDestAddressForAggregation (cons
 {
   return 0;
 }
+uint16_t
+MacLowAggregationCapableTransmissionListener::GetFairShareAmpduLimit (void)
+{
+  return 64;
+}
+uint16_t
+MacLowAggregationCapableTransmissionListener::GetDestinationAmpduLimit (Mac48Address dest)
+{
+  return 64;
+}
+void
+MacLowAggregationCapableTransmissionListener::CompleteAmpduAggregation (Mac48Address dest, uint32_t nMpdus)
+{
+}
 
 MacLowTransmissionParameters::MacLowTransmissionParameters ()
   : m_nextSize (0),
@@ -369,7 +381,10 @@ MacLow::MacLow ()
     m_phyMacLowListener (0),
     m_ctsToSelfSupported (false),
     m_receivedAtLeastOneMpdu (false),
-    m_mpduReferenceNumber (0)
+    m_mpduReferenceNumber (0),
+    m_ampduPreamble (WIFI_PREAMBLE_LONG),
+    m_ampduFrequency (0),
+    m_ampduMaxSize (0)
 {
   NS_LOG_FUNCTION (this);
   m_lastNavDuration = Seconds (0);
@@ -727,7 +742,7 @@ MacLow::StartTransmission (Ptr<const Packet> packet,
                            MacLowTransmissionParameters params,
                            MacLowTransmissionListener *listener)
 {
-  NS_LOG_FUNCTION (this << packet << hdr << params << listener);
+  HOT_LOG_FUNCTION (this << packet << hdr << params << listener);
   /* m_currentPacket is not NULL because someone started
    * a transmission and was interrupted before one of:
    *   - ctsTimeout
@@ -791,7 +806,7 @@ MacLow::StartTransmission (Ptr<const Packet> packet,
         }
     }
 
-  NS_LOG_DEBUG ("startTx size=" << GetSize (m_currentPacket, &m_currentHdr) <<
+  HOT_LOG_DEBUG ("startTx size=" << GetSize (m_currentPacket, &m_currentHdr) <<
                 ", to=" << m_currentHdr.GetAddr1 () << ", listener=" << m_listener);
 
   if (m_txParams.MustSendRts ())
@@ -824,8 +839,8 @@ MacLow::NeedCtsToSelf (void)
 void
 MacLow::ReceiveError (Ptr<const Packet> packet, double rxSnr)
 {
-  NS_LOG_FUNCTION (this << packet << rxSnr);
-  NS_LOG_DEBUG ("rx failed ");
+  HOT_LOG_FUNCTION (this << packet << rxSnr);
+  HOT_LOG_DEBUG ("rx failed ");
   AmpduTag ampdu;
   Ptr<Packet> pkt = packet->Copy ();
   bool isInAmpdu = pkt->RemovePacketTag (ampdu);
@@ -842,7 +857,7 @@ MacLow::ReceiveError (Ptr<const Packet> packet, double rxSnr)
           AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), tid));
           if (it != m_bAckAgreements.end ())
             {
-              NS_LOG_DEBUG ("last a-mpdu subframe detected/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("last a-mpdu subframe detected/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
               m_sendAckEvent = Simulator::Schedule (GetSifs (),
                                                     &MacLow::SendBlockAckAfterAmpdu, this,
                                                     hdr.GetQosTid (),
@@ -854,7 +869,7 @@ MacLow::ReceiveError (Ptr<const Packet> packet, double rxSnr)
         }
       else if (hdr.IsBlockAckReq ())
         {
-          NS_LOG_DEBUG ("last a-mpdu subframe is BAR");
+          HOT_LOG_DEBUG ("last a-mpdu subframe is BAR");
           m_receivedAtLeastOneMpdu = false;
         }
     }
@@ -901,7 +916,7 @@ MacLow::NotifySleepNow (void)
 void
 MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, WifiPreamble preamble, bool ampduSubframe)
 {
-  NS_LOG_FUNCTION (this << packet << rxSnr << txVector.GetMode () << preamble);
+  HOT_LOG_FUNCTION (this << packet << rxSnr << txVector.GetMode () << preamble);
   /* A packet is received from the PHY.
    * When we have handled this packet,
    * we handle any packet present in the
@@ -911,7 +926,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
   packet->RemoveHeader (hdr);
 
   bool isPrevNavZero = IsNavZero ();
-  NS_LOG_DEBUG ("duration/id=" << hdr.GetDuration ());
+  HOT_LOG_DEBUG ("duration/id=" << hdr.GetDuration ());
   NotifyNav (packet, hdr, preamble);
   if (hdr.IsRts ())
     {
@@ -930,7 +945,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
           if (isPrevNavZero
               && hdr.GetAddr1 () == m_self)
             {
-              NS_LOG_DEBUG ("rx RTS from=" << hdr.GetAddr2 () << ", schedule CTS");
+              HOT_LOG_DEBUG ("rx RTS from=" << hdr.GetAddr2 () << ", schedule CTS");
               NS_ASSERT (m_sendCtsEvent.IsExpired ());
               m_stationManager->ReportRxOk (hdr.GetAddr2 (), &hdr,
                                             rxSnr, txVector.GetMode ());
@@ -943,7 +958,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
             }
           else
             {
-              NS_LOG_DEBUG ("rx RTS from=" << hdr.GetAddr2 () << ", cannot schedule CTS");
+              HOT_LOG_DEBUG ("rx RTS from=" << hdr.GetAddr2 () << ", cannot schedule CTS");
             }
         }
     }
@@ -957,7 +972,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
           NS_FATAL_ERROR ("Received CTS as part of an A-MPDU");
         }
 
-      NS_LOG_DEBUG ("receive cts from=" << m_currentHdr.GetAddr1 ());
+      HOT_LOG_DEBUG ("receive cts from=" << m_currentHdr.GetAddr1 ());
 
       SnrTag tag;
       packet->RemovePacketTag (tag);
@@ -982,7 +997,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
                || m_superFastAckTimeoutEvent.IsRunning ())
            && m_txParams.MustWaitAck ())
     {
-      NS_LOG_DEBUG ("receive ack from=" << m_currentHdr.GetAddr1 ());
+      HOT_LOG_DEBUG ("receive ack from=" << m_currentHdr.GetAddr1 ());
       SnrTag tag;
       packet->RemovePacketTag (tag);
       m_stationManager->ReportRxOk (m_currentHdr.GetAddr1 (), &m_currentHdr,
@@ -1022,7 +1037,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
            && (m_txParams.MustWaitBasicBlockAck () || m_txParams.MustWaitCompressedBlockAck ())
            && m_blockAckTimeoutEvent.IsRunning ())
     {
-      NS_LOG_DEBUG ("got block ack from " << hdr.GetAddr2 ());
+      HOT_LOG_DEBUG ("got block ack from " << hdr.GetAddr2 ());
       CtrlBAckResponseHeader blockAck;
       packet->RemoveHeader (blockAck);
       m_blockAckTimeoutEvent.Cancel ();
@@ -1052,7 +1067,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
               ResetBlockAckInactivityTimerIfNeeded (it->second.first);
               if ((*it).second.first.IsImmediateBlockAck ())
                 {
-                  NS_LOG_DEBUG ("rx blockAckRequest/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
+                  HOT_LOG_DEBUG ("rx blockAckRequest/sendImmediateBlockAck from=" << hdr.GetAddr2 ());
                   m_sendAckEvent = Simulator::Schedule (GetSifs (),
                                                         &MacLow::SendBlockAckAfterBlockAckRequest, this,
                                                         blockAckReq,
@@ -1068,7 +1083,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
             }
           else
             {
-              NS_LOG_DEBUG ("There's not a valid agreement for this block ack request.");
+              HOT_LOG_DEBUG ("There's not a valid agreement for this block ack request.");
             }
         }
       else
@@ -1078,7 +1093,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
     }
   else if (hdr.IsCtl ())
     {
-      NS_LOG_DEBUG ("rx drop " << hdr.GetTypeString ());
+      HOT_LOG_DEBUG ("rx drop " << hdr.GetTypeString ());
       m_receivedAtLeastOneMpdu = false;
     }
   else if (hdr.GetAddr1 () == m_self)
@@ -1094,7 +1109,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
              QoS Control field of the QoS data frame. */
           if (hdr.IsQosAck () && !ampduSubframe)
             {
-              NS_LOG_DEBUG ("rx QoS unicast/sendAck from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx QoS unicast/sendAck from=" << hdr.GetAddr2 ());
               AgreementsI it = m_bAckAgreements.find (std::make_pair (hdr.GetAddr2 (), hdr.GetQosTid ()));
 
               RxCompleteBufferedPacketsWithSmallerSequence (it->second.first.GetStartingSequenceControl (),
@@ -1135,11 +1150,11 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
         {
           if (ampduSubframe)
             {
-              NS_LOG_DEBUG ("rx Ampdu with No Ack Policy from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx Ampdu with No Ack Policy from=" << hdr.GetAddr2 ());
             }
           else
             {
-              NS_LOG_DEBUG ("rx unicast/noAck from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx unicast/noAck from=" << hdr.GetAddr2 ());
             }
         }
       else if (hdr.IsData () || hdr.IsMgt ())
@@ -1150,7 +1165,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
             }
           else
             {
-              NS_LOG_DEBUG ("rx unicast/sendAck from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx unicast/sendAck from=" << hdr.GetAddr2 ());
               NS_ASSERT (m_sendAckEvent.IsExpired ());
               m_sendAckEvent = Simulator::Schedule (GetSifs (),
                                                     &MacLow::SendAckAfterData, this,
@@ -1173,7 +1188,7 @@ MacLow::ReceiveOk (Ptr<Packet> packet, double rxSnr, WifiTxVector txVector, Wifi
         {
           if (hdr.IsData () || hdr.IsMgt ())
             {
-              NS_LOG_DEBUG ("rx group from=" << hdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx group from=" << hdr.GetAddr2 ());
               m_receivedAtLeastOneMpdu = false;
               goto rxPacket;
             }
@@ -1593,8 +1608,8 @@ void
 MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr,
                      WifiTxVector txVector, WifiPreamble preamble)
 {
-  NS_LOG_FUNCTION (this << packet << hdr << txVector);
-  NS_LOG_DEBUG ("send " << hdr->GetTypeString () <<
+  HOT_LOG_FUNCTION (this << packet << hdr << txVector);
+  HOT_LOG_DEBUG ("send " << hdr->GetTypeString () <<
                 ", to=" << hdr->GetAddr1 () <<
                 ", size=" << packet->GetSize () <<
                 ", mode=" << txVector.GetMode  () <<
@@ -1648,7 +1663,7 @@ MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr,
             {
               if (!vhtSingleMpdu)
                 {
-                  NS_LOG_DEBUG ("Sending MPDU as part of A-MPDU");
+                  HOT_LOG_DEBUG ("Sending MPDU as part of A-MPDU");
                   packetType = 1;
                 }
               else
@@ -1674,15 +1689,15 @@ MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr,
 void
 MacLow::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, WifiPreamble preamble, uint8_t packetType, uint32_t mpduReferenceNumber)
 {
-  NS_LOG_DEBUG ("Sending MPDU as part of A-MPDU");
+  HOT_LOG_DEBUG ("Sending MPDU as part of A-MPDU");
   m_phy->SendPacket (packet, txVector, preamble, packetType, mpduReferenceNumber);
 }
 
 void
 MacLow::CtsTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("cts timeout");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("cts timeout");
   /// \todo should check that there was no rx start before now.
   /// we should restart a new cts timeout now until the expected
   /// end of rx if there was a rx start before now.
@@ -1701,7 +1716,7 @@ MacLow::CtsTimeout (void)
 void
 MacLow::NormalAckTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   MY_DEBUG ("normal ack timeout");
   /// \todo should check that there was no rx start before now.
   /// we should restart a new ack timeout now until the expected
@@ -1718,26 +1733,26 @@ MacLow::NormalAckTimeout (void)
 void
 MacLow::FastAckTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_stationManager->ReportDataFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
   MacLowTransmissionListener *listener = m_listener;
   m_listener = 0;
   if (m_phy->IsStateIdle ())
     {
-      NS_LOG_DEBUG ("fast Ack idle missed");
+      HOT_LOG_DEBUG ("fast Ack idle missed");
       listener->MissedAck ();
     }
   else
     {
-      NS_LOG_DEBUG ("fast Ack ok");
+      HOT_LOG_DEBUG ("fast Ack ok");
     }
 }
 
 void
 MacLow::BlockAckTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("block ack timeout");
+  HOT_LOG_FUNCTION (this);
+  HOT_LOG_DEBUG ("block ack timeout");
 
   m_stationManager->ReportDataFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
   MacLowTransmissionListener *listener = m_listener;
@@ -1751,18 +1766,18 @@ MacLow::BlockAckTimeout (void)
 void
 MacLow::SuperFastAckTimeout ()
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   m_stationManager->ReportDataFailed (m_currentHdr.GetAddr1 (), &m_currentHdr);
   MacLowTransmissionListener *listener = m_listener;
   m_listener = 0;
   if (m_phy->IsStateIdle ())
     {
-      NS_LOG_DEBUG ("super fast Ack failed");
+      HOT_LOG_DEBUG ("super fast Ack failed");
       listener->MissedAck ();
     }
   else
     {
-      NS_LOG_DEBUG ("super fast Ack ok");
+      HOT_LOG_DEBUG ("super fast Ack ok");
       listener->GotAck (0.0, WifiMode ());
     }
 }
@@ -1770,7 +1785,7 @@ MacLow::SuperFastAckTimeout ()
 void
 MacLow::SendRtsForPacket (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   /* send an RTS for this packet. */
   WifiMacHeader rts;
   rts.SetType (WIFI_MAC_CTL_RTS);
@@ -1936,7 +1951,7 @@ MacLow::StartDataTxTimers (WifiTxVector dataTxVector)
 void
 MacLow::SendDataPacket (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   /* send this packet directly. No RTS is needed. */
   WifiTxVector dataTxVector = GetDataTxVector (m_currentPacket, &m_currentHdr);
   WifiPreamble preamble;
@@ -2117,7 +2132,7 @@ MacLow::SendCtsToSelf (void)
 void
 MacLow::SendCtsAfterRts (Mac48Address source, Time duration, WifiTxVector rtsTxVector, double rtsSnr)
 {
-  NS_LOG_FUNCTION (this << source << duration << rtsTxVector.GetMode () << rtsSnr);
+  HOT_LOG_FUNCTION (this << source << duration << rtsTxVector.GetMode () << rtsSnr);
   /* send a CTS when you receive a RTS
    * right after SIFS.
    */
@@ -2149,7 +2164,7 @@ MacLow::SendCtsAfterRts (Mac48Address source, Time duration, WifiTxVector rtsTxV
 void
 MacLow::SendDataAfterCts (Mac48Address source, Time duration)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   /* send the third step in a
    * RTS/CTS/DATA/ACK hanshake
    */
@@ -2260,17 +2275,17 @@ MacLow::EndTxNoAck (void)
 void
 MacLow::FastAckFailedTimeout (void)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   MacLowTransmissionListener *listener = m_listener;
   m_listener = 0;
   listener->MissedAck ();
-  NS_LOG_DEBUG ("fast Ack busy but missed");
+  HOT_LOG_DEBUG ("fast Ack busy but missed");
 }
 
 void
 MacLow::SendAckAfterData (Mac48Address source, Time duration, WifiMode dataTxMode, double dataSnr)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   /* send an ACK when you receive
    * a packet after SIFS.
    */
@@ -2603,7 +2618,7 @@ MacLow::SendBlockAckResponse (const CtrlBAckResponseHeader* blockAck, Mac48Addre
 void
 MacLow::SendBlockAckAfterAmpdu (uint8_t tid, Mac48Address originator, Time duration, WifiTxVector blockAckReqTxVector)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   CtrlBAckResponseHeader blockAck;
   uint16_t seqNumber = 0;
   BlockAckCachesI i = m_bAckCaches.find (std::make_pair (originator, tid));
@@ -2616,7 +2631,7 @@ MacLow::SendBlockAckAfterAmpdu (uint8_t tid, Mac48Address originator, Time durat
   blockAck.SetTidInfo (tid);
   immediate = (*it).second.first.IsImmediateBlockAck ();
   blockAck.SetType (COMPRESSED_BLOCK_ACK);
-  NS_LOG_DEBUG ("Got Implicit block Ack Req with seq " << seqNumber);
+  HOT_LOG_DEBUG ("Got Implicit block Ack Req with seq " << seqNumber);
   (*i).second.FillBlockAckBitmap (&blockAck);
 
   SendBlockAckResponse (&blockAck, originator, immediate, duration, blockAckReqTxVector.GetMode  ());
@@ -2626,7 +2641,7 @@ void
 MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Mac48Address originator,
                                           Time duration, WifiMode blockAckReqTxMode)
 {
-  NS_LOG_FUNCTION (this);
+  HOT_LOG_FUNCTION (this);
   CtrlBAckResponseHeader blockAck;
   uint8_t tid = 0;
   bool immediate = false;
@@ -2650,7 +2665,7 @@ MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Ma
           BlockAckCachesI i = m_bAckCaches.find (std::make_pair (originator, tid));
           NS_ASSERT (i != m_bAckCaches.end ());
           (*i).second.FillBlockAckBitmap (&blockAck);
-          NS_LOG_DEBUG ("Got block Ack Req with seq " << reqHdr.GetStartingSequence ());
+          HOT_LOG_DEBUG ("Got block Ack Req with seq " << reqHdr.GetStartingSequence ());
 
           if (!m_stationManager->HasHtSupported () && !m_stationManager->HasVhtSupported ())
             {
@@ -2674,7 +2689,7 @@ MacLow::SendBlockAckAfterBlockAckRequest (const CtrlBAckRequestHeader reqHdr, Ma
         }
       else
         {
-          NS_LOG_DEBUG ("there's not a valid block ack agreement with " << originator);
+          HOT_LOG_DEBUG ("there's not a valid block ack agreement with " << originator);
         }
     }
   else
@@ -2735,14 +2750,14 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
 
       WifiMacHeader firsthdr;
       (*n).first->PeekHeader (firsthdr);
-      NS_LOG_DEBUG ("duration/id=" << firsthdr.GetDuration ());
+      HOT_LOG_DEBUG ("duration/id=" << firsthdr.GetDuration ());
       NotifyNav ((*n).first, firsthdr, preamble);
 
       bool vhtSingleMpdu = (*n).second.GetEof ();
       if (vhtSingleMpdu == true)
         {
           //If the MPDU is sent as a VHT single MPDU (EOF=1 in A-MPDU subframe header), then the responder sends an ACK.
-          NS_LOG_DEBUG ("Receive VHT single MPDU");
+          HOT_LOG_DEBUG ("Receive VHT single MPDU");
           ampduSubframe = false;
         }
 
@@ -2755,11 +2770,11 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
             }
           else if (firsthdr.IsData () || firsthdr.IsQosData ())
             {
-              NS_LOG_DEBUG ("Deaggregate packet from " << firsthdr.GetAddr2 () << " with sequence=" << firsthdr.GetSequenceNumber ());
+              HOT_LOG_DEBUG ("Deaggregate packet from " << firsthdr.GetAddr2 () << " with sequence=" << firsthdr.GetSequenceNumber ());
               ReceiveOk ((*n).first, rxSnr, txVector, preamble, ampduSubframe);
               if (firsthdr.IsQosAck ())
                 {
-                  NS_LOG_DEBUG ("Normal Ack");
+                  HOT_LOG_DEBUG ("Normal Ack");
                   normalAck = true;
                 }
             }
@@ -2783,7 +2798,7 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
               NS_ASSERT (m_sendAckEvent.IsExpired ());
               /* See section 11.5.3 in IEEE 802.11 for mean of this timer */
               ResetBlockAckInactivityTimerIfNeeded (it->second.first);
-              NS_LOG_DEBUG ("rx A-MPDU/sendImmediateBlockAck from=" << firsthdr.GetAddr2 ());
+              HOT_LOG_DEBUG ("rx A-MPDU/sendImmediateBlockAck from=" << firsthdr.GetAddr2 ());
               m_sendAckEvent = Simulator::Schedule (GetSifs (),
                                                     &MacLow::SendBlockAckAfterAmpdu, this,
                                                     firsthdr.GetQosTid (),
@@ -2793,7 +2808,7 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
             }
           else
             {
-              NS_LOG_DEBUG ("There's not a valid agreement for this block ack request.");
+              HOT_LOG_DEBUG ("There's not a valid agreement for this block ack request.");
             }
           m_receivedAtLeastOneMpdu = false;
         }
@@ -2804,8 +2819,8 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
     }
 }
 
-bool
-MacLow::StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peekedHdr, Ptr<Packet> aggregatedPacket, uint16_t size) const
+void
+MacLow::StartMpduAggregation (void)
 {
   WifiPreamble preamble;
   WifiTxVector dataTxVector = GetDataTxVector (m_currentPacket, &m_currentHdr);
@@ -2826,22 +2841,72 @@ MacLow::StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peeke
       preamble = WIFI_PREAMBLE_LONG;
     }
 
+  double frequency = m_phy->GetFrequency ();
+  if (m_ampduMaxSize > 0
+      && preamble == m_ampduPreamble
+      && frequency == m_ampduFrequency
+      && dataTxVector.GetMode () == m_ampduTxVector.GetMode ()
+      && dataTxVector.GetChannelWidth () == m_ampduTxVector.GetChannelWidth ()
+      && dataTxVector.IsShortGuardInterval () == m_ampduTxVector.IsShortGuardInterval ()
+      && dataTxVector.GetNss () == m_ampduTxVector.GetNss ())
+    {
+      m_ampduTxVector = dataTxVector;
+      return;
+    }
+  m_ampduTxVector = dataTxVector;
+  m_ampduPreamble = preamble;
+  m_ampduFrequency = frequency;
+
+  //An HT STA shall not transmit a PPDU that has a duration that is greater than aPPDUMaxTime (10 milliseconds).
+  //The duration grows with the size, so the data rate bounds the largest size and a bisection
+  //between the bounds takes care of the preamble and symbol rounding.
+  Time maxDuration = MilliSeconds (10);
+  Time overhead = m_phy->CalculateTxDuration (0, dataTxVector, preamble, frequency, 0, 0);
+  uint64_t dataRate = dataTxVector.GetMode ().GetDataRate (dataTxVector.GetChannelWidth (),
+                                                           dataTxVector.IsShortGuardInterval (),
+                                                           dataTxVector.GetNss ());
+  uint32_t high = maxDuration.GetSeconds () * dataRate / 8;
+  uint32_t low = (maxDuration - overhead).GetSeconds () * dataRate / 8;
+  if (m_phy->CalculateTxDuration (low, dataTxVector, preamble, frequency, 0, 0) > maxDuration)
+    {
+      low = 0;
+    }
+  while (low < high)
+    {
+      uint32_t mid = low + (high - low + 1) / 2;
+      if (m_phy->CalculateTxDuration (mid, dataTxVector, preamble, frequency, 0, 0) <= maxDuration)
+        {
+          low = mid;
+        }
+      else
+        {
+          high = mid - 1;
+        }
+    }
+  m_ampduMaxSize = low;
+  HOT_LOG_DEBUG ("A-MPDU budget " << m_ampduMaxSize << " bytes for " << dataTxVector.GetMode ());
+}
+
+bool
+MacLow::StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peekedHdr, Ptr<Packet> aggregatedPacket, uint16_t size) const
+{
   if (peekedPacket == 0)
     {
-      NS_LOG_DEBUG ("no more packets in queue");
+      HOT_LOG_DEBUG ("no more packets in queue");
       return true;
     }
 
   //An HT STA shall not transmit a PPDU that has a duration that is greater than aPPDUMaxTime (10 milliseconds)
-  if (m_phy->CalculateTxDuration (aggregatedPacket->GetSize () + peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, dataTxVector, preamble, m_phy->GetFrequency (), 0, 0) > MilliSeconds (10))
+  NS_ASSERT (m_ampduMaxSize > 0);
+  if (aggregatedPacket->GetSize () + peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH > m_ampduMaxSize)
     {
-      NS_LOG_DEBUG ("no more packets can be aggregated to satisfy PPDU <= aPPDUMaxTime");
+      HOT_LOG_DEBUG ("no more packets can be aggregated to satisfy PPDU <= aPPDUMaxTime");
       return true;
     }
 
   if (!m_mpduAggregator->CanBeAggregated (peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, aggregatedPacket, size))
     {
-      NS_LOG_DEBUG ("no more packets can be aggregated because the maximum A-MPDU size has been reached");
+      HOT_LOG_DEBUG ("no more packets can be aggregated because the maximum A-MPDU size has been reached");
       return true;
     }
 
@@ -2878,6 +2943,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               /* here is performed mpdu aggregation */
               /* MSDU aggregation happened in edca if the user asked for it so m_currentPacket may contains a normal packet or a A-MSDU */
               currentAggregatedPacket = Create<Packet> ();
+              StartMpduAggregation ();
               peekedHdr = hdr;
               uint16_t startingSequenceNumber = 0;
               uint16_t currentSequenceNumber = 0;
@@ -2885,7 +2951,19 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               uint16_t blockAckSize = 0;
               bool aggregated = false;
               int i = 0;
+              uint32_t queuedMpdus = 0;
               Ptr<Packet> aggPacket = newPacket->Copy ();
+              //CSMA/ECA fair share: 2^stage MPDUs, never more than the block ack window
+              int maxMpdus = 64;
+              if (m_phy->GetPhyFairShare () && hdr.IsQosData ())
+                {
+                  maxMpdus = std::min<int> (listenerIt->second->GetFairShareAmpduLimit (), 64);
+                  HOT_LOG_DEBUG ("Fair share A-MPDU limit: " << maxMpdus << " MPDUs");
+                }
+              if (hdr.IsQosData ())
+                {
+                  maxMpdus = std::min<int> (listenerIt->second->GetDestinationAmpduLimit (hdr.GetAddr1 ()), maxMpdus);
+                }
 
               if (!hdr.IsBlockAckReq ())
                 {
@@ -2903,7 +2981,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
 
                   if (aggregated)
                     {
-                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      HOT_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
                       i++;
                       m_sentMpdus++;
                       m_aggregateQueue->Enqueue (aggPacket, peekedHdr);
@@ -2944,7 +3022,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                   currentSequenceNumber = peekedHdr.GetSequenceNumber ();
                 }
 
-              while (IsInWindow (currentSequenceNumber, startingSequenceNumber, 64) && !StopMpduAggregation (peekedPacket, peekedHdr, currentAggregatedPacket, blockAckSize))
+              while (i < maxMpdus && IsInWindow (currentSequenceNumber, startingSequenceNumber, 64) && !StopMpduAggregation (peekedPacket, peekedHdr, currentAggregatedPacket, blockAckSize))
                 {
                   //for now always send AMPDU with normal ACK
                   if (retry == false)
@@ -2985,7 +3063,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                               InsertInTxQueue (packet, hdr, tstamp);
                             }
                         }
-                      NS_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      HOT_LOG_DEBUG ("Adding packet with Sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
                       i++;
                       isAmpdu = true;
                       m_sentMpdus++;
@@ -3004,6 +3082,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       else
                         {
                           queue->Remove (peekedPacket);
+                          queuedMpdus++;
                         }
                       newPacket = 0;
                     }
@@ -3060,6 +3139,10 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                         }
                     }
                 }
+              if (hdr.IsQosData ())
+                {
+                  listenerIt->second->CompleteAmpduAggregation (hdr.GetAddr1 (), queuedMpdus);
+                }
 
               if (isAmpdu)
                 {
@@ -3084,7 +3167,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                   ampdutag.SetNoOfMpdus (i);
                   newPacket = currentAggregatedPacket;
                   newPacket->AddPacketTag (ampdutag);
-                  NS_LOG_DEBUG ("tx unicast A-MPDU");
+                  HOT_LOG_DEBUG ("tx unicast A-MPDU");
                   listenerIt->second->SetAmpdu (true);
                 }
               else
@@ -3126,7 +3209,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               newPacket->AddTrailer (fcs);
               newPacket->AddPacketTag (ampdutag);
 
-              NS_LOG_DEBUG ("tx unicast VHT single MPDU with sequence number " << hdr.GetSequenceNumber ());
+              HOT_LOG_DEBUG ("tx unicast VHT single MPDU with sequence number " << hdr.GetSequenceNumber ());
               listenerIt->second->SetAmpdu (true);
             }
         }
@@ -3139,7 +3222,7 @@ MacLow::FlushAggregateQueue (void)
 {
   if (m_aggregateQueue->GetSize () > 0)
     {
-      NS_LOG_DEBUG ("Flush aggregate queue");
+      HOT_LOG_DEBUG ("Flush aggregate queue");
       m_aggregateQueue->Flush ();
     }
   m_txPackets.clear ();
@@ -3203,7 +3286,7 @@ MacLow::PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Ti
 
   if (isAmsdu)
     {
-      NS_LOG_DEBUG ("A-MSDU with size = " << currentAmsduPacket->GetSize ());
+      HOT_LOG_DEBUG ("A-MSDU with size = " << currentAmsduPacket->GetSize ());
       hdr->SetQosAmsdu ();
       hdr->SetAddr3 (GetBssid ());
       return currentAmsduPacket;
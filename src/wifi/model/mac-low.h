@@ -283,6 +283,22 @@ public:
   /**
    */
   virtual Mac48Address GetDestAddressForAggregation (const WifiMacHeader &hdr);
+  /**
+   * \return the maximum number of MPDUs allowed in the next A-MPDU when
+   *         CSMA/ECA fair share is done at the A-MPDU level
+   */
+  virtual uint16_t GetFairShareAmpduLimit (void);
+  /**
+   * \param dest the receiver of the next A-MPDU
+   * \return the maximum number of MPDUs allowed in the next A-MPDU to \p dest
+   */
+  virtual uint16_t GetDestinationAmpduLimit (Mac48Address dest);
+  /**
+   * \param dest the receiver of the A-MPDU
+   * \param nMpdus the number of MPDUs taken from the queue into the A-MPDU,
+   *        besides the packet it was built around and any retransmission
+   */
+  virtual void CompleteAmpduAggregation (Mac48Address dest, uint32_t nMpdus);
 };
 
 /**
@@ -805,6 +821,13 @@ public:
    *
    */
   void DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr, WifiTxVector txVector, WifiPreamble preamble);
+  /**
+   * Compute the TXVECTOR and preamble of the A-MPDU about to be built for
+   * the current packet, and the largest A-MPDU size (in bytes) that can be
+   * sent with them within aPPDUMaxTime. The size is only recomputed when
+   * the TXVECTOR, preamble or frequency change.
+   */
+  void StartMpduAggregation (void);
   /**
    * \param peekedPacket the packet to be aggregated
    * \param peekedHdr the WifiMacHeader for the packet.
@@ -1374,6 +1397,10 @@ private:
   bool m_receivedAtLeastOneMpdu;      //!< Flag whether an MPDU has already been successfully received while receiving an A-MPDU
   std::vector<Item> m_txPackets;      //!< Contain temporary items to be sent with the next A-MPDU transmission, once RTS/CTS exchange has succeeded. It is not used in other cases.
   uint32_t m_mpduReferenceNumber;       //!< A-MPDU reference number to identify all subframes belonging to the same A-MPDU
+  WifiTxVector m_ampduTxVector;       //!< TXVECTOR of the A-MPDU being built
+  WifiPreamble m_ampduPreamble;       //!< Preamble of the A-MPDU being built
+  double m_ampduFrequency;            //!< Frequency m_ampduMaxSize was computed for
+  uint32_t m_ampduMaxSize;            //!< Largest A-MPDU size (bytes) within aPPDUMaxTime, 0 if not computed yet
 };
 
 } //namespace ns3
@@ -780,6 +780,17 @@ RegularWifiMac::ConfigureCw (uint32_t cwmin, uint32_t cwmax)
     }
 }
 
+void
+RegularWifiMac::InstallBlockAckAgreement (Ptr<RegularWifiMac> recipient, uint8_t tid)
+{
+  NS_LOG_FUNCTION (this << recipient << static_cast<uint32_t> (tid));
+  NS_ASSERT (m_qosSupported && recipient->m_qosSupported);
+  MgtAddBaResponseHeader respHdr;
+  uint16_t startingSeq = m_edca[QosUtilsMapTidToAc (tid)]->InstallBlockAckAgreement (recipient->GetAddress (),
+                                                                                     tid, &respHdr);
+  recipient->m_low->CreateBlockAckAgreement (&respHdr, GetAddress (), startingSeq);
+}
+
 void
 RegularWifiMac::TxOk (const WifiMacHeader &hdr)
 {
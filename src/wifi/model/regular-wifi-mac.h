@@ -256,6 +256,16 @@ public:
 
   void ConfigureCw (uint32_t cwmin, uint32_t cwmax);
 
+  /**
+   * Install an established block ack agreement for <i>tid</i> between
+   * this MAC (originator) and <i>recipient</i>, without ADDBA frames.
+   * Used by static (pre-associated) topologies.
+   *
+   * \param recipient the MAC of the recipient of the agreement
+   * \param tid traffic ID of the agreement
+   */
+  void InstallBlockAckAgreement (Ptr<RegularWifiMac> recipient, uint8_t tid);
+
 
 
 protected:
@@ -38,6 +38,9 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
 #include "ns3/node.h"
+#include "wifi-net-device.h"
+#include "wifi-mac.h"
+#include "wifi-mac-header.h"
 #include "ampdu-tag.h"
 #include <cmath>
 
@@ -173,6 +176,13 @@ YansWifiPhy::GetTypeId (void)
                    MakeUintegerAccessor (&YansWifiPhy::GetChannelWidth,
                                          &YansWifiPhy::SetChannelWidth),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BeaconAirtimeOnly",
+                   "If true, beacons from a foreign BSS keep the medium busy for their duration "
+                   "but are not synchronized on nor delivered to the MAC. Receivers that have "
+                   "no BSSID yet, and STAs receiving beacons from their own AP, still get them.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiPhy::m_beaconAirtimeOnly),
+                   MakeBooleanChecker ())
     .AddTraceSource ("FramesWithErrors", "Number of frames affected by errors",
                     MakeTraceSourceAccessor (&YansWifiPhy::m_errorFrames),
                     "ns3::Traced::Value::Uint64Callback")
@@ -192,6 +202,7 @@ YansWifiPhy::YansWifiPhy ()
     m_mpdusNum (0),
     m_plcpSuccess (false),
     m_minFer (0),
+    m_beaconAirtimeOnly (false),
     m_errorFrames (0),
     m_rxPowerDbm (0.0)
 {
@@ -679,6 +690,17 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
               m_mpdusNum = 0;
             }
 
+          if (m_beaconAirtimeOnly
+              && preamble != WIFI_PREAMBLE_NONE
+              && IsAirtimeOnlyBeacon (packet))
+            {
+              NS_LOG_DEBUG ("beacon from foreign BSS, charging airtime only");
+              /* Above the ED threshold, so the medium is busy for the whole
+               * beacon even when the energy is below CcaMode1Threshold */
+              m_state->SwitchMaybeToCcaBusy (rxDuration);
+              return;
+            }
+
           NS_LOG_DEBUG ("sync to signal (power=" << rxPowerW << "W)");
           //sync to signal
           m_state->SwitchToRx (rxDuration);
@@ -1223,6 +1245,35 @@ YansWifiPhy::SetFrameMinFer (double fer)
   m_minFer = fer;
 }
 
+bool
+YansWifiPhy::IsAirtimeOnlyBeacon (Ptr<const Packet> packet) const
+{
+  //Beacons are never aggregated, and an A-MPDU does not start with a MAC header
+  AmpduTag ampduTag;
+  if (packet->PeekPacketTag (ampduTag))
+    {
+      return false;
+    }
+  WifiMacHeader hdr;
+  if (packet->PeekHeader (hdr) == 0 || !hdr.IsBeacon ())
+    {
+      return false;
+    }
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (m_device);
+  if (device == 0)
+    {
+      return false;
+    }
+  Mac48Address bssid = device->GetMac ()->GetBssid ();
+  //Not associated yet: the beacon is needed to find an AP
+  if (bssid == Mac48Address ())
+    {
+      return false;
+    }
+  //Our own AP: keep feeding the beacon watchdog of the STA
+  return bssid != hdr.GetAddr3 ();
+}
+
 void
 YansWifiPhy::UpdateFrameErrorCount (void)
 {
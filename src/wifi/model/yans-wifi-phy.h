@@ -414,6 +414,17 @@ public:
 
   void SetFrameMinFer (double minFer);
   double GetFrameMinFer (void);
+  /**
+   * Return whether a beacon that is about to be synchronized on can be
+   * charged as airtime only (CCA busy) instead of being received.
+   * This is the case when the receiving MAC already has a BSSID and the
+   * beacon was sent by a different BSS.
+   *
+   * \param packet the incoming packet
+   *
+   * \return true if the beacon does not need to be delivered
+   */
+  bool IsAirtimeOnlyBeacon (Ptr<const Packet> packet) const;
   void UpdateFrameErrorCount (void);
   void UpdatePreableHeaderTracedPowerRx (double value);
 
@@ -589,6 +600,7 @@ private:
   uint16_t m_mpdusNum;                  //!< carries the number of expected mpdus that are part of an A-MPDU
   bool m_plcpSuccess;                   //!< Flag if the PLCP of the packet or the first MPDU in an A-MPDU has been received
   double m_minFer;                      //!< Minimum frame error rate
+  bool m_beaconAirtimeOnly;             //!< Flag if foreign beacons are only charged as airtime
 
 
   TracedValue<uint64_t> m_errorFrames;  //!< Number of frames affected by m_minFer